@@ -0,0 +1,53 @@
+/*
+ * Benchmark `cherry::BTreeSet` against `std::set` (insert, lookup, iteration and bulk load)
+ */
+
+#include <algorithm>
+#include <set>
+
+#include "cherry.hpp"
+
+/// Insert `keys`, look them up and iterate all, print the times
+template <typename Set>
+void bench(const std::string &name, const std::vector<int64_t> &keys) {
+    Set set;
+    cherry::NanoTimer timer;
+    for (auto key: keys) {
+        set.insert(key);
+    }
+    uint64_t insert_time = timer.tik();
+    size_t found = 0;
+    for (auto key: keys) {
+        found += set.count(key);
+    }
+    uint64_t find_time = timer.tik();
+    int64_t sum = 0;
+    for (auto key: set) {
+        sum += key;
+    }
+    uint64_t iterate_time = timer.tik();
+    if (found != keys.size() or sum == 0) {
+        cherry::early_exit("Wrong results of " + name);
+    }
+    cherry::print_args(name, "insert:", cherry::pretty_nanoseconds(insert_time), "find:", cherry::pretty_nanoseconds(find_time),
+                       "iterate:", cherry::pretty_nanoseconds(iterate_time), "\n");
+}
+
+int main() {
+    std::vector<int64_t> keys(10000000);
+    cherry::Random<int64_t> random(0, INT64_MAX);
+    for (auto &key: keys) {
+        key = random();
+    }
+    bench<std::set<int64_t>>("std::set", keys);
+    bench<cherry::BTreeSet<int64_t>>("cherry::BTreeSet", keys);
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    cherry::NanoTimer timer;
+    cherry::BTreeSet<int64_t> set;
+    set.bulk_load(keys);
+    cherry::print_args("cherry::BTreeSet bulk load:", cherry::pretty_nanoseconds(timer.tik()),
+                       "(" + cherry::pretty_bytes(set.memory()) + ")\n");
+    return 0;
+}
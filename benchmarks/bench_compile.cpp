@@ -0,0 +1,47 @@
+/*
+ * Benchmark the compile time of every Cherry header (a translation unit only including it)
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#include "cherry.hpp"
+
+/// Compile a translation unit with `source` (the best of `repeat_times` runs), return the nanoseconds
+uint64_t compile_time(const std::string &source, int repeat_times=3) {
+    auto path = std::filesystem::temp_directory_path() / "cherry_bench_compile.cpp";
+    std::ofstream(path) << source;
+    std::string command = std::string(CHERRY_COMPILER) + " -std=c++" + std::to_string(CHERRY_CXX_STANDARD) +
+                          " -I" + CHERRY_INCLUDE_DIR + " -c -o /dev/null " + path.string();
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < repeat_times; ++ i) {
+        cherry::NanoTimer timer;
+        if (std::system(command.c_str()) != 0) {
+            cherry::early_exit("Failed to compile: " + command);
+        }
+        best = std::min(best, timer.tik());
+    }
+    std::filesystem::remove(path);
+    return best;
+}
+
+int main() {
+    std::vector<std::string> headers;
+    for (const auto &entry: std::filesystem::directory_iterator(std::string(CHERRY_INCLUDE_DIR) + "/cherry")) {
+        headers.push_back("cherry/" + entry.path().filename().string());
+    }
+    std::sort(headers.begin(), headers.end());
+    headers.emplace_back("cherry.hpp");
+
+    // The cost of a header is measured against an empty translation unit
+    uint64_t baseline = compile_time("int main() { return 0; }\n");
+    cherry::print_args("(empty)", cherry::pretty_nanoseconds(baseline), "\n");
+    for (const auto &header: headers) {
+        uint64_t duration = compile_time("#include \"" + header + "\"\nint main() { return 0; }\n");
+        cherry::print_args(header, cherry::pretty_nanoseconds(duration),
+                           "(+" + cherry::pretty_nanoseconds(duration > baseline ? duration - baseline : 0) + ")\n");
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+/*
+ * Benchmark the scaling of `cherry::SkipListSet` against a mutex-guarded `std::set` from 1 to 64 threads
+ */
+
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "cherry.hpp"
+
+/// A `std::set` guarded by a mutex
+class LockedSet {
+private:
+    std::set<int64_t> set;
+    mutable std::mutex mutex;
+
+public:
+    bool insert(int64_t key) {
+        std::lock_guard<std::mutex> guard(mutex);
+        return set.insert(key).second;
+    }
+
+    bool erase(int64_t key) {
+        std::lock_guard<std::mutex> guard(mutex);
+        return set.erase(key);
+    }
+
+    bool contains(int64_t key) const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return set.count(key);
+    }
+};
+
+/// Run `total_operations` (80% lookups, 10% insertions and 10% erasures on a preloaded set) split among
+/// `threads_count` threads, print the throughput
+template <typename Set>
+void bench(const std::string &name, int threads_count, int total_operations, int64_t key_range) {
+    Set set;
+    cherry::Random<int64_t> preload(0, key_range - 1);
+    for (int64_t i = 0; i < key_range / 2; ++ i) {
+        set.insert(preload());
+    }
+    cherry::Barrier<> start(threads_count + 1);
+    std::atomic<size_t> hits = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; ++ t) {
+        threads.emplace_back([&, t]() {
+            cherry::Random<int64_t> random(0, key_range - 1, false, t + 1);
+            size_t local_hits = 0;
+            start.arrive_and_wait();
+            for (int i = 0; i < total_operations / threads_count; ++ i) {
+                int64_t key = random();
+                switch (i % 10) {
+                    case 0: local_hits += set.insert(key); break;
+                    case 1: local_hits += set.erase(key); break;
+                    default: local_hits += set.contains(key);
+                }
+            }
+            hits += local_hits;
+        });
+    }
+    start.arrive_and_wait();
+    cherry::NanoTimer timer;
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    uint64_t duration = timer.tik();
+    cherry::print_args(name, "(" + std::to_string(threads_count) + " threads):",
+                       cherry::pretty_rate(static_cast<double>(total_operations) * 1e9 / static_cast<double>(duration)), "\n");
+}
+
+int main() {
+    for (int threads_count = 1; threads_count <= 64; threads_count *= 2) {
+        bench<cherry::SkipListSet<int64_t>>("cherry::SkipListSet", threads_count, 4000000, 1000000);
+        bench<LockedSet>("std::mutex + std::set", threads_count, 4000000, 1000000);
+    }
+    return 0;
+}
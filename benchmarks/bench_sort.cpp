@@ -0,0 +1,52 @@
+/*
+ * Benchmark `cherry::sort` on many tiny arrays against `std::sort`
+ */
+
+#include <algorithm>
+
+#include "cherry.hpp"
+
+/// Sort every `n` consecutive items of a copy of `data` with `func`, print the time
+template <typename Function>
+void bench(const std::string &name, const std::vector<int> &data, size_t n, const Function &func) {
+    auto copy = data;
+    cherry::NanoTimer timer;
+    for (size_t i = 0; i + n <= copy.size(); i += n) {
+        func(copy.data() + i);
+    }
+    uint64_t duration = timer.tik();
+    for (size_t i = 0; i + n <= copy.size(); i += n) {
+        if (not std::is_sorted(copy.begin() + static_cast<ptrdiff_t>(i), copy.begin() + static_cast<ptrdiff_t>(i + n))) {
+            cherry::early_exit("Not sorted by " + name);
+        }
+    }
+    cherry::print_args(name, "(n = " + std::to_string(n) + "):", cherry::pretty_nanoseconds(duration), "\n");
+}
+
+template <size_t n>
+void bench_size(const std::vector<int> &data) {
+    bench("std::sort", data, n, [](int *items) {
+        std::sort(items, items + n);
+    });
+    bench("cherry::sort (runtime size)", data, n, [](int *items) {
+        cherry::sort(items, items + n);
+    });
+    bench("cherry::sort (compile-time size)", data, n, [](int *items) {
+        cherry::sort<n>(items);
+    });
+}
+
+int main() {
+    std::vector<int> data(cherry::Unit::MiB(16));
+    cherry::Random<int> random(0, 1000000);
+    for (auto &value: data) {
+        value = random();
+    }
+    bench_size<4>(data);
+    bench_size<8>(data);
+    bench_size<12>(data);
+    bench_size<16>(data);
+    bench_size<24>(data);
+    bench_size<32>(data);
+    return 0;
+}
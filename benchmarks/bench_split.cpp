@@ -0,0 +1,69 @@
+/*
+ * Benchmark `cherry::split` and `cherry::lines` against `std::getline` and `std::istringstream`
+ */
+
+#include <sstream>
+
+#include "cherry.hpp"
+
+/// Run `func` and print the throughput
+template <typename Function>
+void bench(const std::string &name, size_t bytes, const Function &func) {
+    cherry::NanoTimer timer;
+    size_t checksum = func();
+    uint64_t duration = timer.tik();
+    cherry::print_args(name, cherry::pretty_nanoseconds(duration),
+                       cherry::pretty_bytes(static_cast<size_t>(bytes / (static_cast<double>(duration) / 1e9))) + "/s",
+                       "(checksum", std::to_string(checksum) + ")\n");
+}
+
+int main() {
+    // About 64 MiB of lines with comma-separated fields
+    std::string text;
+    cherry::Random<int> random(0, 1000000);
+    while (text.size() < cherry::Unit::MiB(64)) {
+        for (int i = 0; i < 8; ++ i) {
+            text += std::to_string(random()) + (i == 7 ? "\n" : ",");
+        }
+    }
+
+    bench("std::getline (lines)", text.size(), [&]() {
+        std::istringstream stream(text);
+        std::string line;
+        size_t total = 0;
+        while (std::getline(stream, line)) {
+            total += line.size();
+        }
+        return total;
+    });
+
+    bench("cherry::lines", text.size(), [&]() {
+        size_t total = 0;
+        for (const auto &line: cherry::lines(text)) {
+            total += line.size();
+        }
+        return total;
+    });
+
+    bench("std::istringstream (fields)", text.size(), [&]() {
+        std::istringstream stream(text);
+        std::string line, field;
+        size_t total = 0;
+        while (std::getline(stream, line)) {
+            std::istringstream line_stream(line);
+            while (std::getline(line_stream, field, ',')) {
+                total += field.size();
+            }
+        }
+        return total;
+    });
+
+    bench("cherry::split (fields)", text.size(), [&]() {
+        size_t total = 0;
+        for (const auto &field: cherry::split(text, ",\n", true)) {
+            total += field.size();
+        }
+        return total;
+    });
+    return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * Benchmark barrier round-trips of `cherry::Barrier` against a mutex and condition variable barrier
+ */
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "cherry.hpp"
+
+/// A barrier by `std::mutex` and `std::condition_variable`
+class ConditionBarrier {
+private:
+    uint32_t count, remaining, phase = 0;
+    std::mutex mutex;
+    std::condition_variable condition;
+
+public:
+    explicit ConditionBarrier(uint32_t count): count(count), remaining(count) {}
+
+    void arrive_and_wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        uint32_t sense = phase;
+        if (-- remaining == 0) {
+            remaining = count, ++ phase;
+            condition.notify_all();
+        } else {
+            condition.wait(lock, [this, sense]() {
+                return phase != sense;
+            });
+        }
+    }
+};
+
+/// Run `rounds` barrier round-trips among `threads_count` threads, print the time per round-trip
+template <typename BarrierType>
+void bench(const std::string &name, uint32_t threads_count, int rounds) {
+    BarrierType barrier(threads_count);
+    std::vector<std::thread> threads;
+    cherry::NanoTimer timer;
+    for (uint32_t i = 0; i < threads_count; ++ i) {
+        threads.emplace_back([&barrier, rounds]() {
+            for (int round = 0; round < rounds; ++ round) {
+                barrier.arrive_and_wait();
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    uint64_t duration = timer.tik();
+    cherry::print_args(name, "(" + std::to_string(threads_count) + " threads):",
+                       cherry::pretty_nanoseconds(duration / rounds), "per round-trip\n");
+}
+
+int main() {
+    uint32_t max_threads = std::max(2u, std::thread::hardware_concurrency());
+    for (uint32_t threads_count = 2; threads_count <= std::min(max_threads, 64u); threads_count *= 2) {
+        bench<cherry::Barrier<>>("cherry::Barrier", threads_count, 10000);
+        bench<ConditionBarrier>("std::condition_variable", threads_count, 10000);
+    }
+    return 0;
+}
@@ -0,0 +1,56 @@
+/*
+ * Generate skewed key streams with `cherry::Zipf` and `cherry::Pareto`, and drive Cherry's hash structures with them
+ */
+
+#include "cherry.hpp"
+
+/// A workload generator producing key streams from a sampler
+template <typename Sampler>
+std::vector<uint64_t> generate(Sampler &sampler, size_t count, const std::string &name) {
+    std::vector<uint64_t> keys(count);
+    cherry::NanoTimer timer;
+    for (auto &key: keys) {
+        key = static_cast<uint64_t>(sampler());
+    }
+    uint64_t duration = timer.tik();
+    cherry::print_args(name, "generated", count, "keys in", cherry::pretty_nanoseconds(duration),
+                       "(" + cherry::pretty_rate(static_cast<double>(count) / (static_cast<double>(duration) / 1e9)) + ")\n");
+    return keys;
+}
+
+/// Intern the keys as strings and report the distinct ratio and the throughput
+void drive_string_pool(const std::vector<uint64_t> &keys, const std::string &name) {
+    std::vector<std::string> texts;
+    texts.reserve(keys.size());
+    for (const auto &key: keys) {
+        texts.push_back("key:" + std::to_string(key));
+    }
+    cherry::StringPool pool;
+    cherry::NanoTimer timer;
+    uint64_t checksum = 0;
+    for (const auto &text: texts) {
+        checksum += pool.intern(text);
+    }
+    uint64_t duration = timer.tik();
+    cherry::print_args(name, "interned into", pool.size(), "distinct strings in", cherry::pretty_nanoseconds(duration),
+                       "(" + cherry::pretty_rate(static_cast<double>(keys.size()) / (static_cast<double>(duration) / 1e9)) + ",",
+                       "checksum", std::to_string(checksum) + ")\n");
+}
+
+int main() {
+    constexpr size_t count = 10000000;
+    constexpr uint64_t universe = 1000000000ull;
+
+    for (double exponent: {0.8, 0.99, 1.2}) {
+        cherry::Zipf<uint64_t> zipf(universe, exponent, false, 42);
+        auto name = "Zipf(1e9, " + std::to_string(exponent).substr(0, 4) + ")";
+        drive_string_pool(generate(zipf, count, name), name);
+    }
+
+    cherry::Pareto<double> pareto(1.0, 1.16, false, 42);
+    drive_string_pool(generate(pareto, count, "Pareto(1, 1.16)"), "Pareto(1, 1.16)");
+
+    cherry::Random<uint64_t> uniform(1, universe, false, 42);
+    drive_string_pool(generate(uniform, count, "Uniform(1e9)"), "Uniform(1e9)");
+    return 0;
+}
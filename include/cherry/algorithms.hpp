@@ -0,0 +1,163 @@
+/*
+ * Cherry: range algorithms
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "config.hpp"
+
+namespace cherry {
+
+/// Concat two ranges into a `std::vector`
+template <typename Range1, typename Range2, typename value_type = typename Range1::value_type>
+[[maybe_unused]] [[nodiscard]] CHERRY_CONSTEXPR20 std::vector<value_type> concat(const Range1 &range1, const Range2 &range2) {
+    static_assert(std::is_same<typename Range1::value_type, typename Range2::value_type>::value,
+                  "The types of two ranges in function concat must be same");
+    std::vector<value_type> vec;
+    for (const auto &value: range1) {
+        vec.push_back(value);
+    }
+    for (const auto &value: range2) {
+        vec.push_back(value);
+    }
+    return vec;
+}
+
+/// Map all the items in range into another `std::vector`
+template <typename Range, typename Function>
+[[maybe_unused]] [[nodiscard]] CHERRY_CONSTEXPR20 auto map(const Range &range, const Function &f) {
+    std::vector<decltype(f(*range.begin()))> mapped;
+    for (const auto &item: range) {
+        mapped.push_back(f(item));
+    }
+    return mapped;
+}
+
+/// Map the indexes [0, `n`) into a `std::array`, use it with `constexpr` to build a table at compile time
+template <size_t n, typename Function>
+[[maybe_unused]] [[nodiscard]] constexpr auto make_table(const Function &f) {
+    std::array<decltype(f(static_cast<size_t>(0))), n> table{};
+    for (size_t i = 0; i < n; ++ i) {
+        table[i] = f(i);
+    }
+    return table;
+}
+
+/// For each all the items in range (const reference)
+template <typename Range, typename Function>
+[[maybe_unused]] constexpr void for_each(const Range &range, const Function &f) {
+    for (const auto &item: range) {
+        f(item);
+    }
+}
+
+/// For each all the items in range (const reference)
+template <typename Range, typename Function>
+[[maybe_unused]] constexpr void for_each(Range &range, const Function &f) {
+    for (auto &item: range) {
+        f(item);
+    }
+}
+
+/// For each all the items in range (right-value)
+template <typename Range, typename Function>
+[[maybe_unused]] constexpr void for_each(Range &&range, const Function &f) {
+    for (auto &item: range) {
+        f(item);
+    }
+}
+
+/// All of the items in the range satisfy the function
+template <typename Range, typename Function>
+[[maybe_unused]] constexpr bool all_of(const Range &range, const Function &f) {
+    static_assert(std::is_same<bool, decltype(f(*range.begin()))>::value,
+                  "The return type of function f must be bool");
+    for (const auto &item: range) { // NOLINT(readability-use-anyofallof)
+        if (not f(item)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// None of the items in the range satisfies the function
+template <typename Range, typename Function>
+[[maybe_unused]] constexpr bool none_of(const Range &range, const Function &f) {
+    static_assert(std::is_same<bool, decltype(f(*range.begin()))>::value,
+                  "The return type of function f must be bool");
+    for (const auto &item: range) { // NOLINT(readability-use-anyofallof)
+        if (f(item)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Any of the items in the range satisfies the function
+template <typename Range, typename Function>
+[[maybe_unused]] constexpr bool any_of(const Range &range, const Function &f) {
+    static_assert(std::is_same<bool, decltype(f(*range.begin()))>::value,
+                  "The return type of function f must be bool");
+    for (const auto &item: range) { // NOLINT(readability-use-anyofallof)
+        if (f(item)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Find a certain item in a range
+template <typename Range, typename value_type = typename Range::value_type>
+[[maybe_unused]] [[nodiscard]] constexpr bool find(const Range &range, const value_type &value) {
+    for (const auto &item: range) { // NOLINT(readability-use-anyofallof)
+        if (item == value) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Sum of all the values in a range
+template <typename Range, typename value_type = typename Range::value_type>
+[[maybe_unused]] [[nodiscard]] constexpr value_type sum(const Range &range) {
+    value_type sum_value = 0;
+    for (const auto &item: range) {
+        sum_value += item;
+    }
+    return sum_value;
+}
+
+/// Check whether there are two duplicate (equivalent by `operator <`) items in a range (sorted in a copy)
+template <typename Range, typename value_type = typename Range::value_type>
+[[maybe_unused]] [[nodiscard]] bool check_duplicate(const Range &range) {
+    std::vector<value_type> items;
+    for (const auto &item: range) {
+        items.push_back(item);
+    }
+    std::sort(items.begin(), items.end());
+    return std::adjacent_find(items.begin(), items.end(), [](const value_type &a, const value_type &b) {
+        return not (a < b) and not (b < a);
+    }) != items.end();
+}
+
+/// Push all args into a vector
+template <typename value_type>
+[[maybe_unused]] static inline void push(std::vector<value_type> &vec, const value_type &v) {
+    vec.push_back(v);
+}
+
+/// Push all args into a vector
+template <typename value_type, typename ...Args>
+[[maybe_unused]] static inline void push(std::vector<value_type> &vec, const value_type &v, Args... args) {
+    vec.push_back(v);
+    push(vec, args...);
+}
+
+} // namespace cherry
@@ -0,0 +1,165 @@
+/*
+ * Cherry: type-erased ranges
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+#include "ranges.hpp"
+
+namespace cherry {
+
+/// A type-erased read-only range of `T`, one virtual call yields a chunk of up to `chunk` items (or a whole contiguous span)
+template <typename T, size_t chunk=64>
+class [[maybe_unused]] AnyRange {
+private:
+    /// A position in the erased range
+    struct Cursor {
+        virtual ~Cursor() = default;
+
+        /// Point `items` to the next chunk (`buffer` or the underlying storage), return its size (0 for the end)
+        virtual size_t next(T *buffer, const T *&items) = 0;
+    };
+
+    /// An erased range creating cursors
+    struct Source {
+        virtual ~Source() = default;
+
+        [[nodiscard]] virtual std::unique_ptr<Cursor> cursor() const = 0;
+    };
+
+    template <typename iterator_t>
+    struct IteratorCursor: Cursor {
+        iterator_t iterator, end;
+
+        IteratorCursor(iterator_t iterator, iterator_t end): iterator(iterator), end(end) {}
+
+        size_t next(T *buffer, const T *&items) override {
+            size_t count = 0;
+            for (; count < chunk and iterator != end; ++ iterator) {
+                buffer[count ++] = *iterator;
+            }
+            items = buffer;
+            return count;
+        }
+    };
+
+    struct ContiguousCursor: Cursor {
+        const T *pointer;
+        size_t remaining;
+
+        ContiguousCursor(const T *pointer, size_t remaining): pointer(pointer), remaining(remaining) {}
+
+        size_t next(T *, const T *&items) override {
+            items = pointer;
+            return std::exchange(remaining, 0);
+        }
+    };
+
+    /// `Holder` is a reference (for left values) or a value (for right values)
+    template <typename Holder>
+    struct RangeSource: Source {
+        typedef typename std::remove_reference<Holder>::type range_t;
+
+        Holder range;
+
+        explicit RangeSource(Holder range): range(std::forward<Holder>(range)) {}
+
+        [[nodiscard]] std::unique_ptr<Cursor> cursor() const override {
+            const range_t &const_range = range;
+            if constexpr (is_contiguous_range<range_t, T>::value) {
+                return std::make_unique<ContiguousCursor>(const_range.data(), const_range.size());
+            } else {
+                return std::make_unique<IteratorCursor<decltype(const_range.begin())>>(
+                        const_range.begin(), const_range.end());
+            }
+        }
+    };
+
+    std::shared_ptr<const Source> source;
+
+public:
+    [[maybe_unused]] typedef T value_type;
+
+    /// The iterator type for `AnyRange` (input iterator, copies share the position)
+    struct [[maybe_unused]] Iterator {
+        struct State {
+            std::unique_ptr<Cursor> cursor;
+            const T *items = nullptr;
+            size_t index = 0, count = 0;
+            T buffer[chunk];
+        };
+
+        std::shared_ptr<State> state;
+
+        [[maybe_unused]] Iterator() = default;
+
+        [[maybe_unused]] explicit Iterator(std::unique_ptr<Cursor> cursor): state(std::make_shared<State>()) {
+            state->cursor = std::move(cursor);
+            state->count = state->cursor->next(state->buffer, state->items);
+            if (state->count == 0) {
+                state = nullptr;
+            }
+        }
+
+        [[maybe_unused]] const T &operator *() const {
+            return state->items[state->index];
+        }
+
+        [[maybe_unused]] Iterator &operator ++() {
+            if (++ state->index == state->count) {
+                state->index = 0;
+                state->count = state->cursor->next(state->buffer, state->items);
+                if (state->count == 0) {
+                    state = nullptr;
+                }
+            }
+            return *this;
+        }
+
+        [[maybe_unused]] bool operator ==(const Iterator &other) const {
+            return state == other.state;
+        }
+
+        [[maybe_unused]] bool operator !=(const Iterator &other) const {
+            return state != other.state;
+        }
+    };
+
+    typedef Iterator iterator;
+    typedef Iterator const_iterator;
+
+    /// Erase a left-value range (referenced, it must outlive the `AnyRange`)
+    template <typename Range, typename = typename std::enable_if<not std::is_same<
+            typename std::decay<Range>::type, AnyRange>::value>::type>
+    [[maybe_unused]] AnyRange(const Range &range): source(std::make_shared<RangeSource<const Range&>>(range)) {} // NOLINT(google-explicit-constructor)
+
+    /// Erase a right-value range (moved into the `AnyRange`)
+    template <typename Range, typename = typename std::enable_if<not std::is_reference<Range>::value and not std::is_same<
+            typename std::decay<Range>::type, AnyRange>::value>::type>
+    [[maybe_unused]] AnyRange(Range &&range): source(std::make_shared<RangeSource<Range>>(std::move(range))) {} // NOLINT(google-explicit-constructor)
+
+    [[maybe_unused]] [[nodiscard]] const_iterator begin() const {
+        return const_iterator(source->cursor());
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator end() const {
+        return const_iterator();
+    }
+
+    /// Call `f(items, count)` for each chunk, the fastest way to consume an `AnyRange`
+    template <typename Function>
+    [[maybe_unused]] void for_each_chunk(const Function &f) const {
+        auto cursor = source->cursor();
+        T buffer[chunk];
+        const T *items;
+        while (size_t count = cursor->next(buffer, items)) {
+            f(items, count);
+        }
+    }
+};
+
+} // namespace cherry
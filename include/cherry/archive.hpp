@@ -0,0 +1,278 @@
+/*
+ * Cherry: zero-copy binary archives
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <sys/uio.h>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+#include "bitset.hpp"
+#include "mapped_file.hpp"
+
+namespace cherry {
+
+/// A read-only view of a contiguous array (e.g. a section of an `ArchiveReader`)
+template <typename T>
+class [[maybe_unused]] ArrayView {
+private:
+    const T *pointer = nullptr;
+    size_t length = 0;
+
+public:
+    [[maybe_unused]] typedef T value_type;
+    typedef const T* iterator;
+    typedef const T* const_iterator;
+    typedef std::reverse_iterator<const T*> reverse_iterator;
+    typedef std::reverse_iterator<const T*> const_reverse_iterator;
+
+    [[maybe_unused]] ArrayView() = default;
+
+    [[maybe_unused]] ArrayView(const T *pointer, size_t length): pointer(pointer), length(length) {}
+
+    [[maybe_unused]] [[nodiscard]] const T *data() const {
+        return pointer;
+    }
+
+    [[maybe_unused]] [[nodiscard]] size_t size() const {
+        return length;
+    }
+
+    [[maybe_unused]] [[nodiscard]] bool empty() const {
+        return length == 0;
+    }
+
+    [[maybe_unused]] const T &operator [](size_t index) const {
+        assert(index < length);
+        return pointer[index];
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator begin() const {
+        return pointer;
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator end() const {
+        return pointer + length;
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+};
+
+/// The layout of binary archives written by `ArchiveWriter`
+struct [[maybe_unused]] ArchiveFormat {
+    static constexpr char magic[4] = {'C', 'H', 'R', 'Y'};
+    static constexpr uint32_t version = 1;
+    static constexpr uint32_t endianness = 0x01020304;
+    static constexpr uint32_t alignment = 64;
+
+    enum Kind: uint32_t {
+        array = 1,
+        bitset = 2
+    };
+
+    /// The file header, followed by the section table and the aligned section data
+    struct Header {
+        char magic[4];
+        uint32_t version, endianness, alignment;
+        uint64_t sections;
+    };
+
+    /// `count` is elements for arrays and bits for bitsets, `offset` is from the beginning of the file
+    struct Section {
+        uint32_t kind, element_size;
+        uint64_t count, offset, bytes;
+    };
+
+    [[nodiscard]] static constexpr uint64_t align(uint64_t offset) {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+};
+
+/// A binary archive writer for trivially copyable ranges and `Bitset`s, the data is written by `writev` without copying
+class [[maybe_unused]] ArchiveWriter {
+private:
+    std::vector<ArchiveFormat::Section> sections;
+    std::vector<const void*> pointers;
+
+    void add(uint32_t kind, uint32_t element_size, uint64_t count, uint64_t bytes, const void *pointer) {
+        sections.push_back({kind, element_size, count, 0, bytes});
+        pointers.push_back(pointer);
+    }
+
+public:
+    /// Add a contiguous range (with `data()` and `size()`) of trivially copyable items, it must live until `write`
+    template <typename Range>
+    [[maybe_unused]] void add(const Range &range) {
+        typedef typename std::remove_cv<typename std::remove_reference<decltype(*range.data())>::type>::type value_type;
+        static_assert(std::is_trivially_copyable<value_type>::value, "Only trivially copyable items can be archived");
+        add(ArchiveFormat::array, sizeof(value_type), range.size(), range.size() * sizeof(value_type), range.data());
+    }
+
+    /// Add a `Bitset`, it must live until `write`
+    [[maybe_unused]] void add(const Bitset &bitset) {
+        add(ArchiveFormat::bitset, sizeof(uint64_t), bitset.size(),
+            bitset.words_count() * sizeof(uint64_t), bitset.words());
+    }
+
+    /// Write all the sections into a file with `writev`, return whether succeeded
+    [[maybe_unused]] bool write(const std::string &path) {
+        static const char padding[ArchiveFormat::alignment] = {};
+        ArchiveFormat::Header header = {{}, ArchiveFormat::version, ArchiveFormat::endianness,
+                                        ArchiveFormat::alignment, sections.size()};
+        std::memcpy(header.magic, ArchiveFormat::magic, sizeof(header.magic));
+
+        // Lay out the sections
+        uint64_t offset = sizeof(header) + sections.size() * sizeof(ArchiveFormat::Section);
+        std::vector<uint64_t> paddings;
+        for (auto &section: sections) {
+            uint64_t aligned = ArchiveFormat::align(offset);
+            paddings.push_back(aligned - offset);
+            section.offset = aligned;
+            offset = aligned + section.bytes;
+        }
+
+        std::vector<iovec> vectors = {{&header, sizeof(header)}};
+        if (not sections.empty()) {
+            vectors.push_back({sections.data(), sections.size() * sizeof(ArchiveFormat::Section)});
+        }
+        for (size_t i = 0; i < sections.size(); ++ i) {
+            if (paddings[i] > 0) {
+                vectors.push_back({const_cast<char*>(padding), paddings[i]});
+            }
+            if (sections[i].bytes > 0) {
+                vectors.push_back({const_cast<void*>(pointers[i]), sections[i].bytes});
+            }
+        }
+
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::fprintf(stderr, "Failed to open file %s\n", path.c_str());
+            return false;
+        }
+        // One `writev` for everything, loops only on partial writes or more than `IOV_MAX` vectors
+        size_t index = 0;
+        while (index < vectors.size()) {
+            ssize_t written = writev(fd, vectors.data() + index, static_cast<int>(std::min<size_t>(vectors.size() - index, IOV_MAX)));
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                std::fprintf(stderr, "Failed to write file %s\n", path.c_str());
+                close(fd);
+                return false;
+            }
+            while (index < vectors.size() and static_cast<size_t>(written) >= vectors[index].iov_len) {
+                written -= static_cast<ssize_t>(vectors[index ++].iov_len);
+            }
+            if (written > 0) {
+                vectors[index].iov_base = static_cast<char*>(vectors[index].iov_base) + written;
+                vectors[index].iov_len -= written;
+            }
+        }
+        close(fd);
+        return true;
+    }
+};
+
+/// A binary archive reader, the file is mapped and the arrays are read as zero-copy views
+class [[maybe_unused]] ArchiveReader {
+private:
+    MappedFile file;
+    const ArchiveFormat::Section *table = nullptr;
+    size_t count = 0;
+
+    /// Whether a section lies in the file and its size matches its kind, count and element size (without overflow)
+    [[nodiscard]] static bool valid_section(const ArchiveFormat::Section &section, uint64_t file_size) {
+        if (section.offset > file_size or section.bytes > file_size - section.offset) {
+            return false;
+        }
+        if (section.kind == ArchiveFormat::array) {
+            return section.element_size > 0 and section.bytes % section.element_size == 0 and
+                   section.bytes / section.element_size == section.count;
+        }
+        if (section.kind == ArchiveFormat::bitset) {
+            return section.element_size == sizeof(uint64_t) and section.count > 0 and section.count <= INT_MAX and
+                   section.bytes == (section.count + 63) / 64 * sizeof(uint64_t);
+        }
+        return false;
+    }
+
+public:
+    /// Map and check the archive, it is invalid (no sections) if the header does not match
+    [[maybe_unused]] explicit ArchiveReader(const std::string &path): file(path) {
+        ArchiveFormat::Header header = {};
+        if (file.size() < sizeof(header)) {
+            std::fprintf(stderr, "Invalid archive %s\n", path.c_str());
+            return;
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, ArchiveFormat::magic, sizeof(header.magic)) != 0 or
+            header.version != ArchiveFormat::version or header.endianness != ArchiveFormat::endianness or
+            header.alignment != ArchiveFormat::alignment or
+            header.sections > (file.size() - sizeof(header)) / sizeof(ArchiveFormat::Section)) {
+            std::fprintf(stderr, "Incompatible archive %s (magic, version, endianness or alignment)\n", path.c_str());
+            return;
+        }
+        table = reinterpret_cast<const ArchiveFormat::Section*>(file.data() + sizeof(header));
+        for (size_t i = 0; i < header.sections; ++ i) {
+            if (not valid_section(table[i], file.size())) {
+                std::fprintf(stderr, "Corrupted archive %s (section %zu)\n", path.c_str(), i);
+                table = nullptr;
+                return;
+            }
+        }
+        count = header.sections;
+    }
+
+    /// Whether the archive is valid
+    [[maybe_unused]] [[nodiscard]] bool valid() const {
+        return table != nullptr;
+    }
+
+    /// Number of sections
+    [[maybe_unused]] [[nodiscard]] size_t size() const {
+        return count;
+    }
+
+    /// A zero-copy view of an array section (valid as long as the reader), empty if it is not an array of `T`
+    template <typename T>
+    [[maybe_unused]] [[nodiscard]] ArrayView<T> view(size_t index) const {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable items can be archived");
+        if (index >= count or table[index].kind != ArchiveFormat::array or table[index].element_size != sizeof(T)) {
+            std::fprintf(stderr, "Archive section %zu is not an array of %zu-byte items\n", index, sizeof(T));
+            return {};
+        }
+        const auto &section = table[index];
+        return ArrayView<T>(reinterpret_cast<const T*>(file.data() + section.offset), section.count);
+    }
+
+    /// Read a `Bitset` section (one `memcpy` of the words), none if it is not a bitset
+    [[maybe_unused]] [[nodiscard]] std::optional<Bitset> bitset(size_t index) const {
+        if (index >= count or table[index].kind != ArchiveFormat::bitset) {
+            std::fprintf(stderr, "Archive section %zu is not a bitset\n", index);
+            return std::nullopt;
+        }
+        const auto &section = table[index];
+        return Bitset(static_cast<int>(section.count), reinterpret_cast<const uint64_t*>(file.data() + section.offset));
+    }
+};
+
+} // namespace cherry
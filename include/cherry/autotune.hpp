@@ -0,0 +1,206 @@
+/*
+ * Cherry: persistent autotuning of kernels
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "algorithms.hpp"
+#include "timer.hpp"
+
+namespace cherry {
+
+/// A persistent cache of autotuning winners, keyed by (kernel, size bucket, CPU model)
+class [[maybe_unused]] Autotuner {
+private:
+    std::string path, cpu;
+    int repeat_times;
+    std::mutex mutex;
+    // Key: `kernel\tbucket\tcpu`, value: (candidate name, parameter)
+    std::map<std::string, std::pair<std::string, int64_t>> cache;
+
+    [[nodiscard]] std::string key(const std::string &kernel, int bucket) const {
+        return kernel + "\t" + std::to_string(bucket) + "\t" + cpu;
+    }
+
+    void save() {
+        std::ofstream file(path, std::ios::trunc);
+        for (const auto &[entry, winner]: cache) {
+            file << entry << "\t" << winner.first << "\t" << winner.second << "\n";
+        }
+    }
+
+public:
+    /// Load the cache from `path` (a text file, one winner per line), every variant is timed `repeat_times` times
+    [[maybe_unused]] explicit Autotuner(std::string path=".cherry_autotune", int repeat_times=5):
+            path(std::move(path)), cpu(cpu_model()), repeat_times(repeat_times) {
+        assert(repeat_times > 0);
+        std::ifstream file(this->path);
+        std::string line;
+        while (std::getline(file, line)) {
+            // `kernel bucket cpu name param`, separated by tabs
+            auto param_pos = line.rfind('\t');
+            auto name_pos = param_pos == std::string::npos or param_pos == 0 ? std::string::npos : line.rfind('\t', param_pos - 1);
+            if (name_pos == std::string::npos) {
+                continue;
+            }
+            cache[line.substr(0, name_pos)] = {line.substr(name_pos + 1, param_pos - name_pos - 1),
+                                               std::strtoll(line.c_str() + param_pos + 1, nullptr, 10)};
+        }
+    }
+
+    /// The CPU model name of this host (from `/proc/cpuinfo`)
+    [[maybe_unused]] [[nodiscard]] static std::string cpu_model() {
+        std::ifstream file("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.rfind("model name", 0) == 0) {
+                auto pos = line.find(':');
+                auto model = pos == std::string::npos ? line : line.substr(pos + 1);
+                model.erase(0, model.find_first_not_of(' '));
+                std::replace(model.begin(), model.end(), '\t', ' ');
+                return model;
+            }
+        }
+        return "unknown";
+    }
+
+    /// Sizes in the same power-of-2 bucket share a winner
+    [[maybe_unused]] [[nodiscard]] static int size_bucket(size_t size) {
+        int bucket = 0;
+        while (size > 1) {
+            size >>= 1u;
+            ++ bucket;
+        }
+        return bucket;
+    }
+
+    /// Times to run every variant during calibration
+    [[maybe_unused]] [[nodiscard]] int repeats() const {
+        return repeat_times;
+    }
+
+    /// Look up a cached winner, return whether found
+    [[maybe_unused]] bool lookup(const std::string &kernel, int bucket, std::string &name, int64_t &param) {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto iterator = cache.find(key(kernel, bucket));
+        if (iterator == cache.end()) {
+            return false;
+        }
+        name = iterator->second.first, param = iterator->second.second;
+        return true;
+    }
+
+    /// Store a winner and persist the cache
+    [[maybe_unused]] void store(const std::string &kernel, int bucket, const std::string &name, int64_t param) {
+        assert(name.find('\t') == std::string::npos and kernel.find('\t') == std::string::npos);
+        std::lock_guard<std::mutex> guard(mutex);
+        cache[key(kernel, bucket)] = {name, param};
+        save();
+    }
+};
+
+/// A kernel with several candidate implementations, the fastest one (measured by `NanoTimer`) is selected per size bucket
+template <typename... Args>
+class [[maybe_unused]] TunedKernel {
+public:
+    typedef std::function<void(int64_t, Args...)> function_t;
+
+    /// A selected variant (candidate and its parameter)
+    struct Choice {
+        size_t candidate;
+        int64_t param;
+    };
+
+private:
+    struct Candidate {
+        std::string name;
+        std::vector<int64_t> params;
+        function_t function;
+    };
+
+    Autotuner &tuner;
+    std::string kernel;
+    std::vector<Candidate> candidates;
+    std::map<int, Choice> chosen;
+
+    /// Time all the variants on the arguments and return the fastest
+    Choice calibrate(Args... args) {
+        Choice best = {0, 0};
+        uint64_t best_time = std::numeric_limits<uint64_t>::max();
+        for (size_t i = 0; i < candidates.size(); ++ i) {
+            for (const auto &param: candidates[i].params) {
+                // Warm up once, then take the minimum
+                candidates[i].function(param, args...);
+                uint64_t time = std::numeric_limits<uint64_t>::max();
+                for (int k = 0; k < tuner.repeats(); ++ k) {
+                    NanoTimer timer;
+                    candidates[i].function(param, args...);
+                    time = std::min(time, timer.tik());
+                }
+                if (time < best_time) {
+                    best = {i, param}, best_time = time;
+                }
+            }
+        }
+        return best;
+    }
+
+public:
+    [[maybe_unused]] TunedKernel(Autotuner &tuner, std::string kernel): tuner(tuner), kernel(std::move(kernel)) {}
+
+    /// Register a candidate without parameters
+    [[maybe_unused]] void add(const std::string &name, const function_t &function) {
+        add(name, {0}, function);
+    }
+
+    /// Register a candidate with a parameter range (e.g. chunk sizes), the parameter is passed as the first argument
+    [[maybe_unused]] void add(const std::string &name, const std::vector<int64_t> &params, const function_t &function) {
+        assert(not params.empty());
+        candidates.push_back({name, params, function});
+    }
+
+    /// The variant for `size` (calibrated on the arguments if it is neither chosen nor cached)
+    [[maybe_unused]] Choice select(size_t size, Args... args) {
+        assert(not candidates.empty());
+        int bucket = Autotuner::size_bucket(size);
+        auto iterator = chosen.find(bucket);
+        if (iterator != chosen.end()) {
+            return iterator->second;
+        }
+        std::string name;
+        int64_t param;
+        if (tuner.lookup(kernel, bucket, name, param)) {
+            for (size_t i = 0; i < candidates.size(); ++ i) {
+                if (candidates[i].name == name and cherry::find(candidates[i].params, param)) {
+                    return chosen[bucket] = {i, param};
+                }
+            }
+        }
+        Choice choice = calibrate(args...);
+        tuner.store(kernel, bucket, candidates[choice.candidate].name, choice.param);
+        return chosen[bucket] = choice;
+    }
+
+    /// The name of a candidate
+    [[maybe_unused]] [[nodiscard]] const std::string &name(const Choice &choice) const {
+        return candidates[choice.candidate].name;
+    }
+
+    /// Run the selected variant for `size`
+    [[maybe_unused]] void operator ()(size_t size, Args... args) {
+        Choice choice = select(size, args...);
+        candidates[choice.candidate].function(choice.param, args...);
+    }
+};
+
+} // namespace cherry
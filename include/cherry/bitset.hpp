@@ -0,0 +1,267 @@
+/*
+ * Cherry: dynamic and fixed-width bitsets
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+#include "algorithms.hpp"
+
+namespace cherry {
+
+/// Return the lowbit of `x`
+static inline constexpr int lowbit(int x) {
+    return x & (-x);
+}
+
+/// Log2 of integer
+static inline constexpr int log2(int x) {
+    assert(lowbit(x) == x);
+    int k = 0;
+    while ((1 << k) != x) {
+        ++ k;
+    }
+    return k;
+}
+
+// Reverse bytes for int value
+static inline constexpr int reverse_bytes(int value) {
+    auto unsigned_value = static_cast<uint32_t>(value);
+    return static_cast<int>((((unsigned_value & 0x000000ffu) << 24u) |
+                             ((unsigned_value & 0x0000ff00u) << 8u)  |
+                             ((unsigned_value & 0x00ff0000u) >> 8u)  |
+                             ((unsigned_value & 0xff000000u) >> 24u)));
+}
+
+/// Dynamic bitset
+class [[maybe_unused]] Bitset {
+private:
+    typedef uint64_t data_t;
+    int bits = 0, data_length = 0;
+    data_t *data = nullptr;
+    bool hash_calculated = false;
+    uint64_t hash_value = 0;
+
+    [[maybe_unused]] void allocate() {
+        data_length = bits;
+        data_length /= width;
+        data_length += bits % width == 0 ? 0 : 1;
+        assert(data_length > 0);
+        assert(data == nullptr);
+        data = static_cast<data_t*>(std::malloc(data_length * width));
+    }
+
+public:
+    static constexpr size_t width = sizeof(data_t) << 3;
+
+    [[maybe_unused]] explicit Bitset(int bits): bits(bits) {
+        allocate();
+        clear();
+    }
+
+    [[maybe_unused]] Bitset(const Bitset &bitset) {
+        bits = bitset.bits, data_length = bitset.data_length;
+        data = static_cast<data_t*>(std::malloc(data_length * width));
+        memcpy(data, bitset.data, data_length * width);
+        hash_calculated = bitset.hash_calculated;
+        hash_value = bitset.hash_value;
+    }
+
+    [[maybe_unused]] Bitset(int bits, const std::vector<int> &indexes): bits(bits) {
+        allocate();
+        clear();
+        for (const auto &index: indexes) {
+            set_bit(index, true);
+        }
+    }
+
+    /// Construct from raw words (e.g. read from an archive)
+    [[maybe_unused]] Bitset(int bits, const uint64_t *words): bits(bits) {
+        allocate();
+        clear();
+        memcpy(data, words, data_length * sizeof(data_t));
+    }
+
+    [[maybe_unused]] ~Bitset() {
+        assert(data != nullptr);
+        std::free(data);
+    }
+
+    /// Clear all the bits
+    [[maybe_unused]] void clear() {
+        memset(data, 0, data_length * width);
+    }
+
+    /// Check whether all the bits at indexes are 1
+    [[maybe_unused]] [[nodiscard]] bool contains(const std::vector<int> &indexes) const {
+        return all_of(indexes, [this](int index) -> bool {
+            return get_bit(index);
+        });
+    }
+
+    /// Set the bit at `index` to `bit`
+    [[maybe_unused]] void set_bit(int index, bool bit) {
+        // TODO: maybe add a `BitReference` to achieve `[]` operator
+        assert(index >= 0 and index < bits);
+        size_t i = index / width;
+        size_t s = index % width;
+        data[i] |= static_cast<data_t>(1) << s;
+        data[i] ^= static_cast<data_t>(1) << s;
+        data[i] |= static_cast<data_t>(bit) << s;
+        hash_calculated = false;
+    }
+
+    /// Get the bit at `index`
+    [[maybe_unused]] [[nodiscard]] bool get_bit(int index) const {
+        assert(index >= 0 and index < bits);
+        size_t i = index / width;
+        size_t s = index % width;
+        return (data[i] >> s) & static_cast<data_t>(1);
+    }
+
+    /// Number of bits
+    [[maybe_unused]] [[nodiscard]] int size() const {
+        return bits;
+    }
+
+    /// Raw words of the bits
+    [[maybe_unused]] [[nodiscard]] const uint64_t *words() const {
+        return data;
+    }
+
+    /// Number of raw words
+    [[maybe_unused]] [[nodiscard]] int words_count() const {
+        return data_length;
+    }
+
+    /// Get the hash value of the bitset
+    [[maybe_unused]] [[nodiscard]] uint64_t hash() {
+        if (not hash_calculated) {
+            hash_calculated = true;
+            hash_value = 0;
+            for (int i = 0; i < data_length; ++ i) {
+                hash_value = hash_value * 133ull + data[i];
+            }
+        }
+        return hash_value;
+    }
+};
+
+/// Fixed-width bitset, usable in constant expressions (e.g. a `constexpr` table is placed in `.rodata`)
+template <size_t bits>
+class [[maybe_unused]] FixedBitset {
+private:
+    typedef uint64_t data_t;
+    static constexpr size_t width = sizeof(data_t) << 3;
+    static constexpr size_t data_length = (bits + width - 1) / width;
+    static_assert(bits > 0, "FixedBitset must have at least one bit");
+
+    data_t data[data_length] = {};
+
+public:
+    [[maybe_unused]] constexpr FixedBitset() = default;
+
+    [[maybe_unused]] constexpr FixedBitset(std::initializer_list<size_t> indexes) {
+        for (const auto &index: indexes) {
+            set_bit(index, true);
+        }
+    }
+
+    /// Convert into a dynamic bitset
+    [[maybe_unused]] [[nodiscard]] Bitset to_bitset() const {
+        return {static_cast<int>(bits), data};
+    }
+
+    /// Clear all the bits
+    [[maybe_unused]] constexpr void clear() {
+        for (auto &word: data) {
+            word = 0;
+        }
+    }
+
+    /// Set the bit at `index` to `bit`
+    [[maybe_unused]] constexpr void set_bit(size_t index, bool bit) {
+        assert(index < bits);
+        data_t mask = static_cast<data_t>(1) << (index % width);
+        data[index / width] = bit ? (data[index / width] | mask) : (data[index / width] & ~mask);
+    }
+
+    /// Get the bit at `index`
+    [[maybe_unused]] [[nodiscard]] constexpr bool get_bit(size_t index) const {
+        assert(index < bits);
+        return (data[index / width] >> (index % width)) & static_cast<data_t>(1);
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr bool operator [](size_t index) const {
+        return get_bit(index);
+    }
+
+    /// Number of 1 bits
+    [[maybe_unused]] [[nodiscard]] constexpr size_t count() const {
+        size_t count = 0;
+        for (const auto &word: data) {
+            count += __builtin_popcountll(word);
+        }
+        return count;
+    }
+
+    /// Number of bits
+    [[maybe_unused]] [[nodiscard]] static constexpr size_t size() {
+        return bits;
+    }
+
+    /// Raw words of the bits
+    [[maybe_unused]] [[nodiscard]] constexpr const uint64_t *words() const {
+        return data;
+    }
+
+    /// Number of raw words
+    [[maybe_unused]] [[nodiscard]] static constexpr size_t words_count() {
+        return data_length;
+    }
+
+    [[maybe_unused]] constexpr FixedBitset &operator |=(const FixedBitset &other) {
+        for (size_t i = 0; i < data_length; ++ i) {
+            data[i] |= other.data[i];
+        }
+        return *this;
+    }
+
+    [[maybe_unused]] constexpr FixedBitset &operator &=(const FixedBitset &other) {
+        for (size_t i = 0; i < data_length; ++ i) {
+            data[i] &= other.data[i];
+        }
+        return *this;
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr FixedBitset operator |(const FixedBitset &other) const {
+        FixedBitset result = *this;
+        return result |= other;
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr FixedBitset operator &(const FixedBitset &other) const {
+        FixedBitset result = *this;
+        return result &= other;
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr bool operator ==(const FixedBitset &other) const {
+        for (size_t i = 0; i < data_length; ++ i) {
+            if (data[i] != other.data[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr bool operator !=(const FixedBitset &other) const {
+        return not (*this == other);
+    }
+};
+
+} // namespace cherry
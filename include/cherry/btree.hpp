@@ -0,0 +1,826 @@
+/*
+ * Cherry: cache-friendly B+-tree ordered set and map
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+namespace cherry {
+
+/// Number of the `n` sorted keys less than `x` (not greater than `x` if `inclusive`), which is the lower (upper) bound,
+/// arithmetic keys ordered by `std::less` are counted by SIMD comparisons instead of a branchy binary search
+template <bool inclusive, typename Key, typename Compare>
+[[maybe_unused]] static inline size_t node_rank(const Key *keys, size_t n, const Key &x, const Compare &compare) {
+    constexpr bool less = std::is_same<Compare, std::less<>>::value or std::is_same<Compare, std::less<Key>>::value;
+    if constexpr (not less or not std::is_arithmetic<Key>::value) {
+        if constexpr (inclusive) {
+            return std::upper_bound(keys, keys + n, x, compare) - keys;
+        } else {
+            return std::lower_bound(keys, keys + n, x, compare) - keys;
+        }
+    } else {
+        size_t count = 0, i = 0;
+#if defined(__SSE2__)
+        if constexpr (std::is_same<Key, float>::value) {
+            __m128 pivot = _mm_set1_ps(x);
+            for (; i + 4 <= n; i += 4) {
+                __m128 items = _mm_loadu_ps(keys + i);
+                count += __builtin_popcount(_mm_movemask_ps(inclusive ? _mm_cmple_ps(items, pivot) : _mm_cmplt_ps(items, pivot)));
+            }
+        } else if constexpr (std::is_same<Key, double>::value) {
+            __m128d pivot = _mm_set1_pd(x);
+            for (; i + 2 <= n; i += 2) {
+                __m128d items = _mm_loadu_pd(keys + i);
+                count += __builtin_popcount(_mm_movemask_pd(inclusive ? _mm_cmple_pd(items, pivot) : _mm_cmplt_pd(items, pivot)));
+            }
+        } else if constexpr (std::is_integral<Key>::value and sizeof(Key) == 4) {
+            // Unsigned keys are compared as signed ones with the sign bits flipped
+            __m128i flip = _mm_set1_epi32(std::is_signed<Key>::value ? 0 : INT32_MIN);
+            __m128i pivot = _mm_xor_si128(_mm_set1_epi32(static_cast<int32_t>(x)), flip);
+            for (; i + 4 <= n; i += 4) {
+                __m128i items = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), flip);
+                if constexpr (inclusive) {
+                    count += 4 - __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(items, pivot))));
+                } else {
+                    count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(items, pivot))));
+                }
+            }
+        }
+#if defined(__SSE4_2__)
+        else if constexpr (std::is_integral<Key>::value and sizeof(Key) == 8) {
+            __m128i flip = _mm_set1_epi64x(std::is_signed<Key>::value ? 0 : INT64_MIN);
+            __m128i pivot = _mm_xor_si128(_mm_set1_epi64x(static_cast<int64_t>(x)), flip);
+            for (; i + 2 <= n; i += 2) {
+                __m128i items = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), flip);
+                if constexpr (inclusive) {
+                    count += 2 - __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(items, pivot))));
+                } else {
+                    count += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(pivot, items))));
+                }
+            }
+        }
+#endif
+#endif
+        // Branchless tail (and other arithmetic types)
+        for (; i < n; ++ i) {
+            count += inclusive ? not (x < keys[i]) : keys[i] < x;
+        }
+        return count;
+    }
+}
+
+/// An allocator of objects of one type, carving them out of 64 KiB blocks at cache-line boundaries
+/// and recycling the destroyed ones by a free list
+template <typename T>
+class [[maybe_unused]] NodeArena {
+private:
+    static_assert(sizeof(T) >= sizeof(void*), "NodeArena objects must be able to hold a free-list pointer");
+
+    static constexpr size_t alignment = std::max<size_t>(alignof(T), 64);
+    static constexpr size_t stride = (sizeof(T) + alignment - 1) / alignment * alignment;
+    static constexpr size_t block_count = std::max<size_t>(1, 65536 / stride);
+
+    std::vector<void*> blocks;
+    size_t used = block_count, live = 0;
+    void *free_list = nullptr;
+
+public:
+    NodeArena() = default;
+
+    NodeArena(const NodeArena &) = delete;
+
+    NodeArena &operator =(const NodeArena &) = delete;
+
+    [[maybe_unused]] NodeArena(NodeArena &&other) noexcept {
+        swap(other);
+    }
+
+    [[maybe_unused]] NodeArena &operator =(NodeArena &&other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~NodeArena() {
+        release();
+    }
+
+    [[maybe_unused]] void swap(NodeArena &other) noexcept {
+        std::swap(blocks, other.blocks);
+        std::swap(used, other.used);
+        std::swap(live, other.live);
+        std::swap(free_list, other.free_list);
+    }
+
+    /// Construct an object
+    template <typename... Args>
+    [[maybe_unused]] T *create(Args&&... args) {
+        void *address;
+        if (free_list != nullptr) {
+            address = free_list;
+            free_list = *static_cast<void**>(free_list);
+        } else {
+            if (used == block_count) {
+                blocks.push_back(::operator new(block_count * stride, std::align_val_t(alignment)));
+                used = 0;
+            }
+            address = static_cast<char*>(blocks.back()) + (used ++) * stride;
+        }
+        ++ live;
+        return new (address) T(std::forward<Args>(args)...);
+    }
+
+    /// Destroy an object and keep its memory for later `create`
+    [[maybe_unused]] void destroy(T *object) {
+        object->~T();
+        *reinterpret_cast<void**>(object) = free_list;
+        free_list = object;
+        -- live;
+    }
+
+    /// Free all the memory (the objects must be destroyed before unless they are trivially destructible)
+    [[maybe_unused]] void release() {
+        for (void *block: blocks) {
+            ::operator delete(block, std::align_val_t(alignment));
+        }
+        blocks.clear();
+        used = block_count, live = 0;
+        free_list = nullptr;
+    }
+
+    /// Number of live objects
+    [[maybe_unused]] [[nodiscard]] size_t size() const {
+        return live;
+    }
+
+    /// Bytes of the allocated blocks
+    [[maybe_unused]] [[nodiscard]] size_t memory() const {
+        return blocks.size() * block_count * stride;
+    }
+};
+
+/// An in-memory B+-tree of unique keys (a set if `Value` is `void`, otherwise a map), nodes take `node_bytes`
+/// (a few cache lines) from a `NodeArena`, and leaves are linked for the iteration; keys and values must be
+/// default-constructible, erasing only frees emptied nodes without rebalancing
+template <typename Key, typename Value, typename Compare = std::less<Key>, size_t node_bytes = 256>
+class [[maybe_unused]] BTree {
+private:
+    static constexpr bool is_map = not std::is_void<Value>::value;
+    typedef typename std::conditional<is_map, Value, char>::type stored_t;
+
+public:
+    /// Keys in a leaf
+    static constexpr size_t leaf_capacity = std::max<size_t>(
+            4, (node_bytes - 3 * sizeof(void*)) / (sizeof(Key) + (is_map ? sizeof(stored_t) : 0)));
+
+    /// Keys in an inner node (which has one more child)
+    static constexpr size_t inner_capacity = std::max<size_t>(
+            4, (node_bytes - 2 * sizeof(void*)) / (sizeof(Key) + sizeof(void*)));
+
+private:
+    struct alignas(64) LeafNode {
+        uint32_t count = 0;
+        LeafNode *prev = nullptr, *next = nullptr;
+        Key keys[leaf_capacity];
+        stored_t values[is_map ? leaf_capacity : 1];
+    };
+
+    // Child `i` holds the keys in [`keys[i - 1]`, `keys[i]`)
+    struct alignas(64) InnerNode {
+        uint32_t count = 0;
+        Key keys[inner_capacity];
+        void *children[inner_capacity + 1];
+    };
+
+    // The inner nodes and child indexes from the root to a leaf
+    typedef std::array<std::pair<InnerNode*, size_t>, 64> Path;
+
+    NodeArena<LeafNode> leaves;
+    NodeArena<InnerNode> inners;
+    void *root = nullptr;
+    LeafNode *head = nullptr, *tail = nullptr;
+    size_t levels = 0, total = 0;
+    Compare compare;
+
+    template <typename Item>
+    static const Key &item_key(const Item &item) {
+        if constexpr (is_map) {
+            return std::get<0>(item);
+        } else {
+            return item;
+        }
+    }
+
+    LeafNode *descend(const Key &key, Path *path) const {
+        void *node = root;
+        for (size_t level = 0; level + 1 < levels; ++ level) {
+            auto inner = static_cast<InnerNode*>(node);
+            size_t index = node_rank<true>(inner->keys, inner->count, key, compare);
+            if (path != nullptr) {
+                (*path)[level] = {inner, index};
+            }
+            node = inner->children[index];
+        }
+        return static_cast<LeafNode*>(node);
+    }
+
+    LeafNode *split_leaf(LeafNode *leaf) {
+        LeafNode *sibling = leaves.create();
+        size_t middle = leaf_capacity / 2;
+        std::move(leaf->keys + middle, leaf->keys + leaf_capacity, sibling->keys);
+        if constexpr (is_map) {
+            std::move(leaf->values + middle, leaf->values + leaf_capacity, sibling->values);
+        }
+        sibling->count = leaf_capacity - middle;
+        leaf->count = middle;
+        sibling->prev = leaf, sibling->next = leaf->next;
+        (leaf->next != nullptr ? leaf->next->prev : tail) = sibling;
+        leaf->next = sibling;
+        return sibling;
+    }
+
+    static void insert_into_inner(InnerNode *inner, size_t index, Key &&separator, void *right) {
+        std::move_backward(inner->keys + index, inner->keys + inner->count, inner->keys + inner->count + 1);
+        std::move_backward(inner->children + index + 1, inner->children + inner->count + 1,
+                           inner->children + inner->count + 2);
+        inner->keys[index] = std::move(separator);
+        inner->children[index + 1] = right;
+        ++ inner->count;
+    }
+
+    // Insert `right` next to the child at `path[level]`, splitting the full nodes upwards
+    void insert_separator(Path &path, ptrdiff_t level, Key separator, void *right) {
+        if (level < 0) {
+            InnerNode *inner = inners.create();
+            inner->keys[0] = std::move(separator);
+            inner->children[0] = root, inner->children[1] = right;
+            inner->count = 1;
+            root = inner;
+            ++ levels;
+            return;
+        }
+        auto [inner, index] = path[level];
+        if (inner->count < inner_capacity) {
+            insert_into_inner(inner, index, std::move(separator), right);
+            return;
+        }
+        // The middle key goes up
+        InnerNode *sibling = inners.create();
+        size_t middle = inner_capacity / 2;
+        Key up = std::move(inner->keys[middle]);
+        std::move(inner->keys + middle + 1, inner->keys + inner_capacity, sibling->keys);
+        std::copy(inner->children + middle + 1, inner->children + inner_capacity + 1, sibling->children);
+        sibling->count = inner_capacity - middle - 1;
+        inner->count = middle;
+        if (index <= middle) {
+            insert_into_inner(inner, index, std::move(separator), right);
+        } else {
+            insert_into_inner(sibling, index - middle - 1, std::move(separator), right);
+        }
+        insert_separator(path, level - 1, std::move(up), sibling);
+    }
+
+    // Remove the child at `path[level]` (already destroyed) and the emptied nodes above
+    void remove_child(Path &path, ptrdiff_t level) {
+        auto [inner, index] = path[level];
+        if (inner->count == 0) {
+            assert(level > 0);
+            inners.destroy(inner);
+            remove_child(path, level - 1);
+            return;
+        }
+        size_t key_index = index > 0 ? index - 1 : 0;
+        std::move(inner->keys + key_index + 1, inner->keys + inner->count, inner->keys + key_index);
+        std::copy(inner->children + index + 1, inner->children + inner->count + 1, inner->children + index);
+        -- inner->count;
+        // A root with a single child is dropped
+        while (levels > 1 and static_cast<InnerNode*>(root)->count == 0) {
+            auto old_root = static_cast<InnerNode*>(root);
+            root = old_root->children[0];
+            inners.destroy(old_root);
+            -- levels;
+        }
+    }
+
+    void destroy_inner(InnerNode *inner, size_t level) {
+        if (level + 2 < levels) {
+            for (size_t i = 0; i <= inner->count; ++ i) {
+                destroy_inner(static_cast<InnerNode*>(inner->children[i]), level + 1);
+            }
+        }
+        inners.destroy(inner);
+    }
+
+    template <typename... Args>
+    std::pair<LeafNode*, size_t> emplace_key(const Key &key, bool &inserted, Args&&... args) {
+        if (levels == 0) {
+            root = head = tail = leaves.create();
+            levels = 1;
+        }
+        Path path;
+        LeafNode *leaf = descend(key, &path);
+        size_t index = node_rank<false>(leaf->keys, leaf->count, key, compare);
+        if (index < leaf->count and not compare(key, leaf->keys[index])) {
+            inserted = false;
+            return {leaf, index};
+        }
+        if (leaf->count == leaf_capacity) {
+            LeafNode *sibling = split_leaf(leaf);
+            if (index > leaf->count) {
+                index -= leaf->count;
+                leaf = sibling;
+            }
+            insert_separator(path, static_cast<ptrdiff_t>(levels) - 2, sibling->keys[0], sibling);
+        }
+        std::move_backward(leaf->keys + index, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+        leaf->keys[index] = key;
+        if constexpr (is_map) {
+            std::move_backward(leaf->values + index, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+            leaf->values[index] = stored_t(std::forward<Args>(args)...);
+        }
+        ++ leaf->count, ++ total;
+        inserted = true;
+        return {leaf, index};
+    }
+
+    bool erase_key(const Key &key) {
+        if (levels == 0) {
+            return false;
+        }
+        Path path;
+        LeafNode *leaf = descend(key, &path);
+        size_t index = node_rank<false>(leaf->keys, leaf->count, key, compare);
+        if (index == leaf->count or compare(key, leaf->keys[index])) {
+            return false;
+        }
+        if (-- total == 0) {
+            clear();
+            return true;
+        }
+        std::move(leaf->keys + index + 1, leaf->keys + leaf->count, leaf->keys + index);
+        if constexpr (is_map) {
+            std::move(leaf->values + index + 1, leaf->values + leaf->count, leaf->values + index);
+        }
+        if (-- leaf->count == 0) {
+            (leaf->prev != nullptr ? leaf->prev->next : head) = leaf->next;
+            (leaf->next != nullptr ? leaf->next->prev : tail) = leaf->prev;
+            leaves.destroy(leaf);
+            remove_child(path, static_cast<ptrdiff_t>(levels) - 2);
+        }
+        return true;
+    }
+
+    // The leaf and the index of a key (a null leaf if absent)
+    std::pair<LeafNode*, size_t> locate(const Key &key) const {
+        if (levels == 0) {
+            return {nullptr, 0};
+        }
+        LeafNode *leaf = descend(key, nullptr);
+        size_t index = node_rank<false>(leaf->keys, leaf->count, key, compare);
+        if (index == leaf->count or compare(key, leaf->keys[index])) {
+            return {nullptr, 0};
+        }
+        return {leaf, index};
+    }
+
+    template <bool inclusive, typename IteratorType>
+    IteratorType bound(const Key &key) const {
+        if (levels == 0) {
+            return IteratorType(this, nullptr, 0);
+        }
+        LeafNode *leaf = descend(key, nullptr);
+        return IteratorType(this, leaf, node_rank<inclusive>(leaf->keys, leaf->count, key, compare));
+    }
+
+public:
+    /// The iterator type for `BTree`, which can also move by `n` items skipping whole leaves (for `shift`)
+    template <bool is_const>
+    class [[maybe_unused]] Iterator {
+    private:
+        friend class BTree;
+
+        template <bool>
+        friend class Iterator;
+
+        const BTree *tree = nullptr;
+        LeafNode *leaf = nullptr;
+        size_t index = 0;
+
+        // The end of a leaf is the beginning of the next one
+        Iterator(const BTree *tree, LeafNode *leaf, size_t index): tree(tree), leaf(leaf), index(index) {
+            if (leaf != nullptr and index == leaf->count) {
+                this->leaf = leaf->next, this->index = 0;
+            }
+        }
+
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef typename std::conditional<is_map, std::pair<Key, stored_t>, Key>::type value_type;
+        typedef typename std::conditional<is_const, const stored_t&, stored_t&>::type value_reference;
+        typedef typename std::conditional<is_map, std::pair<const Key&, value_reference>, const Key&>::type reference;
+        typedef void pointer;
+        typedef ptrdiff_t difference_type;
+
+        Iterator() = default;
+
+        /// A const iterator from a mutable one
+        template <bool other_const, typename = typename std::enable_if<is_const and not other_const>::type>
+        [[maybe_unused]] Iterator(const Iterator<other_const> &other): tree(other.tree), leaf(other.leaf), index(other.index) {}
+
+        [[maybe_unused]] reference operator *() const {
+            if constexpr (is_map) {
+                return reference(leaf->keys[index], leaf->values[index]);
+            } else {
+                return leaf->keys[index];
+            }
+        }
+
+        [[maybe_unused]] [[nodiscard]] const Key &key() const {
+            return leaf->keys[index];
+        }
+
+        template <bool map = is_map, typename = typename std::enable_if<map>::type>
+        [[maybe_unused]] [[nodiscard]] value_reference value() const {
+            return leaf->values[index];
+        }
+
+        [[maybe_unused]] Iterator &operator ++() {
+            if (++ index == leaf->count) {
+                leaf = leaf->next, index = 0;
+            }
+            return *this;
+        }
+
+        [[maybe_unused]] Iterator operator ++(int) {
+            Iterator copy = *this;
+            ++ *this;
+            return copy;
+        }
+
+        [[maybe_unused]] Iterator &operator --() {
+            return *this -= 1;
+        }
+
+        [[maybe_unused]] Iterator operator --(int) {
+            Iterator copy = *this;
+            -- *this;
+            return copy;
+        }
+
+        [[maybe_unused]] Iterator &operator +=(difference_type n) {
+            if (n < 0) {
+                return *this -= -n;
+            }
+            while (n > 0) {
+                auto rest = static_cast<difference_type>(leaf->count - index);
+                if (n < rest) {
+                    index += n;
+                    break;
+                }
+                n -= rest;
+                leaf = leaf->next, index = 0;
+            }
+            return *this;
+        }
+
+        [[maybe_unused]] Iterator &operator -=(difference_type n) {
+            if (n < 0) {
+                return *this += -n;
+            }
+            while (n > 0) {
+                if (leaf == nullptr) {
+                    leaf = tree->tail, index = leaf->count;
+                }
+                if (n <= static_cast<difference_type>(index)) {
+                    index -= n;
+                    break;
+                }
+                n -= static_cast<difference_type>(index);
+                leaf = leaf->prev, index = leaf->count;
+            }
+            return *this;
+        }
+
+        [[maybe_unused]] Iterator operator +(difference_type n) const {
+            Iterator copy = *this;
+            return copy += n;
+        }
+
+        [[maybe_unused]] Iterator operator -(difference_type n) const {
+            Iterator copy = *this;
+            return copy -= n;
+        }
+
+        /// The distance from `other`, walking by whole leaves
+        [[maybe_unused]] difference_type operator -(const Iterator &other) const {
+            difference_type distance = 0;
+            LeafNode *node = other.leaf;
+            size_t offset = other.index;
+            while (node != leaf) {
+                if (node == nullptr) {
+                    return -(other - *this);
+                }
+                distance += static_cast<difference_type>(node->count - offset);
+                node = node->next, offset = 0;
+            }
+            return distance + static_cast<difference_type>(index) - static_cast<difference_type>(offset);
+        }
+
+        [[maybe_unused]] bool operator ==(const Iterator &other) const {
+            return leaf == other.leaf and index == other.index;
+        }
+
+        [[maybe_unused]] bool operator !=(const Iterator &other) const {
+            return leaf != other.leaf or index != other.index;
+        }
+    };
+
+    typedef Iterator<not is_map> iterator;
+    typedef Iterator<true> const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+    [[maybe_unused]] typedef typename const_iterator::value_type value_type;
+
+    BTree() = default;
+
+    [[maybe_unused]] explicit BTree(const Compare &compare): compare(compare) {}
+
+    [[maybe_unused]] BTree(std::initializer_list<value_type> items, const Compare &compare=Compare()): compare(compare) {
+        bulk_load(items);
+    }
+
+    [[maybe_unused]] BTree(const BTree &other): compare(other.compare) {
+        bulk_load(other);
+    }
+
+    [[maybe_unused]] BTree(BTree &&other) noexcept {
+        swap(other);
+    }
+
+    [[maybe_unused]] BTree &operator =(const BTree &other) {
+        if (this != &other) {
+            compare = other.compare;
+            bulk_load(other);
+        }
+        return *this;
+    }
+
+    [[maybe_unused]] BTree &operator =(BTree &&other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~BTree() {
+        clear();
+    }
+
+    [[maybe_unused]] void swap(BTree &other) noexcept {
+        leaves.swap(other.leaves);
+        inners.swap(other.inners);
+        std::swap(root, other.root);
+        std::swap(head, other.head);
+        std::swap(tail, other.tail);
+        std::swap(levels, other.levels);
+        std::swap(total, other.total);
+        std::swap(compare, other.compare);
+    }
+
+    /// Remove all the items and free the nodes
+    [[maybe_unused]] void clear() {
+        if constexpr (not std::is_trivially_destructible<Key>::value or not std::is_trivially_destructible<stored_t>::value) {
+            for (LeafNode *leaf = head, *next; leaf != nullptr; leaf = next) {
+                next = leaf->next;
+                leaves.destroy(leaf);
+            }
+            if (levels > 1) {
+                destroy_inner(static_cast<InnerNode*>(root), 0);
+            }
+        }
+        leaves.release();
+        inners.release();
+        root = nullptr, head = tail = nullptr;
+        levels = total = 0;
+    }
+
+    /// Replace the content by the items of a range in O(n) if they are sorted and unique (for maps, the items are
+    /// key-value pairs), leaves are filled up and the inner levels are built bottom-up; otherwise insert one by one
+    template <typename Range>
+    [[maybe_unused]] void bulk_load(const Range &range) {
+        clear();
+        bool sorted = true;
+        for (auto previous = range.begin(), current = previous; current != range.end(); previous = current) {
+            if (++ current != range.end() and not compare(item_key(*previous), item_key(*current))) {
+                sorted = false;
+                break;
+            }
+        }
+        if (not sorted) {
+            for (const auto &item: range) {
+                if constexpr (is_map) {
+                    insert(std::get<0>(item), std::get<1>(item));
+                } else {
+                    insert(item);
+                }
+            }
+            return;
+        }
+
+        // The nodes of a level with their minimum keys
+        std::vector<std::pair<void*, Key>> nodes;
+        LeafNode *leaf = nullptr;
+        for (const auto &item: range) {
+            if (leaf == nullptr or leaf->count == leaf_capacity) {
+                LeafNode *next = leaves.create();
+                next->prev = leaf;
+                (leaf != nullptr ? leaf->next : head) = next;
+                leaf = tail = next;
+                nodes.emplace_back(leaf, item_key(item));
+            }
+            leaf->keys[leaf->count] = item_key(item);
+            if constexpr (is_map) {
+                leaf->values[leaf->count] = std::get<1>(item);
+            }
+            ++ leaf->count, ++ total;
+        }
+        if (total == 0) {
+            return;
+        }
+        levels = 1;
+        while (nodes.size() > 1) {
+            std::vector<std::pair<void*, Key>> parents;
+            for (size_t i = 0; i < nodes.size(); ) {
+                size_t children = std::min(inner_capacity + 1, nodes.size() - i);
+                // Leave at least two children for the last node
+                if (nodes.size() - i - children == 1) {
+                    -- children;
+                }
+                InnerNode *inner = inners.create();
+                inner->children[0] = nodes[i].first;
+                for (size_t j = 1; j < children; ++ j) {
+                    inner->keys[j - 1] = std::move(nodes[i + j].second);
+                    inner->children[j] = nodes[i + j].first;
+                }
+                inner->count = children - 1;
+                parents.emplace_back(inner, std::move(nodes[i].second));
+                i += children;
+            }
+            nodes = std::move(parents);
+            ++ levels;
+        }
+        root = nodes[0].first;
+    }
+
+    /// Insert a key (set), return the position and whether it was inserted
+    template <bool map = is_map, typename = typename std::enable_if<not map>::type>
+    [[maybe_unused]] std::pair<iterator, bool> insert(const Key &key) {
+        bool inserted;
+        auto [leaf, index] = emplace_key(key, inserted);
+        return {iterator(this, leaf, index), inserted};
+    }
+
+    /// Insert a key and its value (map) if the key is absent, return the position and whether it was inserted
+    template <typename V, bool map = is_map, typename = typename std::enable_if<map>::type>
+    [[maybe_unused]] std::pair<iterator, bool> insert(const Key &key, V &&value) {
+        bool inserted;
+        auto [leaf, index] = emplace_key(key, inserted, std::forward<V>(value));
+        return {iterator(this, leaf, index), inserted};
+    }
+
+    /// The value of a key, inserted as default if absent (map)
+    template <bool map = is_map, typename = typename std::enable_if<map>::type>
+    [[maybe_unused]] stored_t &operator [](const Key &key) {
+        bool inserted;
+        auto [leaf, index] = emplace_key(key, inserted);
+        return leaf->values[index];
+    }
+
+    /// Erase a key, return the number of erased items
+    [[maybe_unused]] size_t erase(const Key &key) {
+        return erase_key(key);
+    }
+
+    /// Erase the item at `position`, return the position of the next item
+    [[maybe_unused]] iterator erase(const_iterator position) {
+        LeafNode *leaf = position.leaf, *next = leaf->next;
+        size_t index = position.index;
+        bool emptied = leaf->count == 1;
+        erase_key(Key(position.key()));
+        return emptied ? iterator(this, next, 0) : iterator(this, leaf, index);
+    }
+
+    [[maybe_unused]] [[nodiscard]] iterator find(const Key &key) {
+        auto [leaf, index] = locate(key);
+        return leaf != nullptr ? iterator(this, leaf, index) : end();
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator find(const Key &key) const {
+        auto [leaf, index] = locate(key);
+        return leaf != nullptr ? const_iterator(this, leaf, index) : end();
+    }
+
+    [[maybe_unused]] [[nodiscard]] bool contains(const Key &key) const {
+        return locate(key).first != nullptr;
+    }
+
+    [[maybe_unused]] [[nodiscard]] size_t count(const Key &key) const {
+        return contains(key);
+    }
+
+    /// The first item not less than `key`
+    [[maybe_unused]] [[nodiscard]] iterator lower_bound(const Key &key) {
+        return bound<false, iterator>(key);
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator lower_bound(const Key &key) const {
+        return bound<false, const_iterator>(key);
+    }
+
+    /// The first item greater than `key`
+    [[maybe_unused]] [[nodiscard]] iterator upper_bound(const Key &key) {
+        return bound<true, iterator>(key);
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator upper_bound(const Key &key) const {
+        return bound<true, const_iterator>(key);
+    }
+
+    [[maybe_unused]] [[nodiscard]] size_t size() const {
+        return total;
+    }
+
+    [[maybe_unused]] [[nodiscard]] bool empty() const {
+        return total == 0;
+    }
+
+    /// Number of levels (0 if empty)
+    [[maybe_unused]] [[nodiscard]] size_t depth() const {
+        return levels;
+    }
+
+    /// Bytes of the node memory
+    [[maybe_unused]] [[nodiscard]] size_t memory() const {
+        return leaves.memory() + inners.memory();
+    }
+
+    [[maybe_unused]] [[nodiscard]] iterator begin() {
+        return iterator(this, head, 0);
+    }
+
+    [[maybe_unused]] [[nodiscard]] iterator end() {
+        return iterator(this, nullptr, 0);
+    }
+
+    [[maybe_unused]] [[nodiscard]] reverse_iterator rbegin() {
+        return reverse_iterator(end());
+    }
+
+    [[maybe_unused]] [[nodiscard]] reverse_iterator rend() {
+        return reverse_iterator(begin());
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator begin() const {
+        return const_iterator(this, head, 0);
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator end() const {
+        return const_iterator(this, nullptr, 0);
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+};
+
+/// An ordered set by B+-tree
+template <typename Key, typename Compare = std::less<Key>, size_t node_bytes = 256>
+using BTreeSet = BTree<Key, void, Compare, node_bytes>;
+
+/// An ordered map by B+-tree
+template <typename Key, typename Value, typename Compare = std::less<Key>, size_t node_bytes = 256>
+using BTreeMap = BTree<Key, Value, Compare, node_bytes>;
+
+} // namespace cherry
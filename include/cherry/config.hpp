@@ -0,0 +1,24 @@
+/*
+ * Cherry: feature detection and macros shared by all the headers
+ */
+
+#pragma once
+
+// C++20 coroutines are opt-in (`Generator`)
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+#define CHERRY_COROUTINES
+#include <coroutine>
+#include <exception>
+#endif
+
+// `constexpr` which needs C++20 (dynamic allocation during constant evaluation, e.g. `std::vector`)
+#if __cplusplus >= 202002L && defined(__cpp_constexpr_dynamic_alloc)
+#define CHERRY_CONSTEXPR20 constexpr
+#else
+#define CHERRY_CONSTEXPR20
+#endif
+
+// Returning a const value is not recommended by Clang-Tidy for readability, but for functionality we need it
+#pragma ide diagnostic ignored "readability-const-return-type"
+// There are some macros maybe unused
+#pragma ide diagnostic ignored "OCUnusedMacroInspection"
@@ -0,0 +1,180 @@
+/*
+ * Cherry: deadline-aware algorithms
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "timer.hpp"
+
+namespace cherry {
+
+/// A cancellation flag shared between a requester and workers
+class [[maybe_unused]] StopToken {
+private:
+    std::atomic<bool> stopped{false};
+
+public:
+    /// Request the work to stop
+    [[maybe_unused]] void request_stop() {
+        stopped.store(true, std::memory_order_relaxed);
+    }
+
+    /// Whether a stop is requested
+    [[maybe_unused]] [[nodiscard]] bool stop_requested() const {
+        return stopped.load(std::memory_order_relaxed);
+    }
+};
+
+/// A latency budget (and optional `StopToken`), the clock is only read every N iterations with N adapted to the loop speed
+class [[maybe_unused]] Deadline {
+private:
+    static constexpr uint64_t max_stride = 1ull << 20u;
+
+    NanoTimer timer;
+    const StopToken *token;
+    uint64_t budget, elapsed = 0, check_period;
+    uint64_t stride = 1, countdown = 1;
+    bool stopped = false;
+
+    /// Read the clock and the token, then adapt the stride to check about every `check_period` nanoseconds
+    bool check() {
+        if (token != nullptr and token->stop_requested()) {
+            return stopped = true;
+        }
+        uint64_t duration = timer.tik();
+        elapsed += duration;
+        if (elapsed >= budget) {
+            return stopped = true;
+        }
+        uint64_t adapted = stride * check_period / std::max<uint64_t>(duration, 1);
+        stride = std::max<uint64_t>(1, std::min({adapted, stride * 2, max_stride}));
+        countdown = stride;
+        return false;
+    }
+
+public:
+    /// Budget in nanoseconds (e.g. `Unit::ms(5)`)
+    [[maybe_unused]] explicit Deadline(uint64_t budget, const StopToken *token=nullptr): token(token), budget(budget) {
+        check_period = std::max<uint64_t>(std::min<uint64_t>(budget / 64, 50000), 100);
+    }
+
+    /// No budget, only stopped by the token
+    [[maybe_unused]] explicit Deadline(const StopToken &token):
+            Deadline(std::numeric_limits<uint64_t>::max(), &token) {}
+
+    /// Called once per iteration, return whether the work should stop (sticky)
+    [[maybe_unused]] inline bool expired() {
+        if (stopped) {
+            return true;
+        }
+        if (-- countdown > 0) {
+            return false;
+        }
+        return check();
+    }
+
+    /// Nanoseconds consumed at the last check
+    [[maybe_unused]] [[nodiscard]] uint64_t consumed() const {
+        return elapsed;
+    }
+};
+
+/// Progress of a deadline-aware algorithm
+struct [[maybe_unused]] Progress {
+    size_t processed = 0;
+    bool completed = false;
+};
+
+/// A (partial) result of a deadline-aware algorithm
+template <typename T>
+struct [[maybe_unused]] Partial: Progress {
+    T value;
+};
+
+/// For each the items in range until the deadline (const reference)
+template <typename Range, typename Function>
+[[maybe_unused]] Progress for_each(const Range &range, const Function &f, Deadline &deadline) {
+    Progress progress;
+    for (const auto &item: range) {
+        if (deadline.expired()) {
+            return progress;
+        }
+        f(item);
+        ++ progress.processed;
+    }
+    progress.completed = true;
+    return progress;
+}
+
+/// For each the items in range until the deadline (left-value reference)
+template <typename Range, typename Function>
+[[maybe_unused]] Progress for_each(Range &range, const Function &f, Deadline &deadline) {
+    Progress progress;
+    for (auto &item: range) {
+        if (deadline.expired()) {
+            return progress;
+        }
+        f(item);
+        ++ progress.processed;
+    }
+    progress.completed = true;
+    return progress;
+}
+
+/// For each the items in range until the deadline (right-value)
+template <typename Range, typename Function>
+[[maybe_unused]] Progress for_each(Range &&range, const Function &f, Deadline &deadline) {
+    return for_each(range, f, deadline);
+}
+
+/// Any of the items in the range satisfies the function, `completed` is false if the deadline cuts the search
+template <typename Range, typename Function>
+[[maybe_unused]] Partial<bool> any_of(const Range &range, const Function &f, Deadline &deadline) {
+    static_assert(std::is_same<bool, decltype(f(*range.begin()))>::value,
+                  "The return type of function f must be bool");
+    Partial<bool> result = {{0, false}, false};
+    for (const auto &item: range) {
+        if (deadline.expired()) {
+            return result;
+        }
+        ++ result.processed;
+        if (f(item)) {
+            result.value = result.completed = true;
+            return result;
+        }
+    }
+    result.completed = true;
+    return result;
+}
+
+/// Find a certain item in a range, `completed` is false if the deadline cuts the search
+template <typename Range, typename value_type = typename Range::value_type>
+[[maybe_unused]] [[nodiscard]] Partial<bool> find(const Range &range, const value_type &value, Deadline &deadline) {
+    return any_of(range, [&value](const value_type &item) -> bool {
+        return item == value;
+    }, deadline);
+}
+
+/// Map the items in range into another `std::vector` until the deadline (the prefix mapped)
+template <typename Range, typename Function>
+[[maybe_unused]] [[nodiscard]] auto map(const Range &range, const Function &f, Deadline &deadline) {
+    Partial<std::vector<decltype(f(*range.begin()))>> result;
+    for (const auto &item: range) {
+        if (deadline.expired()) {
+            return result;
+        }
+        result.value.push_back(f(item));
+        ++ result.processed;
+    }
+    result.completed = true;
+    return result;
+}
+
+} // namespace cherry
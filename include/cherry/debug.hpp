@@ -0,0 +1,222 @@
+/*
+ * Cherry: flight recorder and error raisers
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+#include "sink.hpp"
+
+namespace cherry {
+
+/// A per-thread in-memory ring of binary events, dumped on fatal exits (async-signal-safe)
+class [[maybe_unused]] FlightRecorder {
+public:
+    /// A raw event, `tag` must be a string literal (or live until the dump)
+    struct Event {
+        uint64_t time;
+        const char *tag;
+        uint64_t a, b;
+    };
+
+    /// Events kept per thread (a power of 2)
+    static constexpr uint64_t capacity = 4096;
+    /// Max threads recorded
+    static constexpr int max_threads = 256;
+
+private:
+    static_assert((capacity & (capacity - 1)) == 0, "The capacity of FlightRecorder must be a power of 2");
+
+    struct Ring {
+        std::atomic<uint64_t> head{0};
+        int thread_index = 0;
+        Event events[capacity];
+    };
+
+    static inline std::atomic<int> thread_count{0};
+    static inline std::atomic<Ring*> rings[max_threads] = {};
+
+    /// The ring of the current thread (leaked on purpose, so that it can be dumped after the thread exits),
+    /// threads beyond `max_threads` get none and remember it
+    [[nodiscard]] static inline Ring *local_ring() {
+        thread_local Ring *ring = nullptr;
+        thread_local bool disabled = false;
+        if (__builtin_expect(ring == nullptr, 0)) {
+            if (disabled) {
+                return nullptr;
+            }
+            // The count never goes beyond `max_threads`
+            int index = thread_count.load(std::memory_order_relaxed);
+            do {
+                if (index >= max_threads) {
+                    disabled = true;
+                    return nullptr;
+                }
+            } while (not thread_count.compare_exchange_weak(index, index + 1, std::memory_order_relaxed));
+            ring = new Ring();
+            ring->thread_index = index;
+            rings[index].store(ring, std::memory_order_release);
+        }
+        return ring;
+    }
+
+    /// A cheap timestamp (TSC ticks on x86, nanoseconds otherwise)
+    [[nodiscard]] static inline uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __builtin_ia32_rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    /// Append a string into a buffer (async-signal-safe)
+    static inline void append(char *buffer, size_t &length, const char *text) {
+        while (*text and length < 255) {
+            buffer[length ++] = *(text ++);
+        }
+    }
+
+    /// Append an unsigned number into a buffer (async-signal-safe)
+    static inline void append(char *buffer, size_t &length, uint64_t value) {
+        char digits[20];
+        int count = 0;
+        do {
+            digits[count ++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        while (count > 0 and length < 255) {
+            buffer[length ++] = digits[-- count];
+        }
+    }
+
+    /// Write a whole buffer into `fd`, ignoring errors (async-signal-safe)
+    static inline void write_all(int fd, const char *buffer, size_t length) {
+        while (length > 0) {
+            ssize_t written = ::write(fd, buffer, length);
+            if (written <= 0) {
+                return;
+            }
+            buffer += written, length -= written;
+        }
+    }
+
+    static void signal_handler(int signal) {
+        Sink::flush_standard_output_on_signal();
+        dump(STDERR_FILENO);
+        // The handler is installed with `SA_RESETHAND`, so raise again for the default action
+        raise(signal);
+    }
+
+public:
+    /// Record an event into the current thread's ring
+    [[maybe_unused]] static inline void record(const char *tag, uint64_t a=0, uint64_t b=0) {
+        Ring *ring = local_ring();
+        if (ring == nullptr) {
+            return;
+        }
+        uint64_t head = ring->head.load(std::memory_order_relaxed);
+        ring->events[head & (capacity - 1)] = {ticks(), tag, a, b};
+        ring->head.store(head + 1, std::memory_order_release);
+    }
+
+    /// Decode and write the last `count` events of every thread into `fd` (async-signal-safe)
+    [[maybe_unused]] static void dump(int fd=STDERR_FILENO, uint64_t count=capacity) {
+        int threads = thread_count.load(std::memory_order_acquire);
+        for (int i = 0; i < threads; ++ i) {
+            Ring *ring = rings[i].load(std::memory_order_acquire);
+            if (ring == nullptr) {
+                continue;
+            }
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            uint64_t size = std::min(std::min(head, capacity), count);
+            char buffer[256];
+            size_t length = 0;
+            append(buffer, length, "[Flight recorder] thread #");
+            append(buffer, length, static_cast<uint64_t>(ring->thread_index));
+            append(buffer, length, ", last ");
+            append(buffer, length, size);
+            append(buffer, length, " events:\n");
+            write_all(fd, buffer, length);
+            for (uint64_t j = head - size; j < head; ++ j) {
+                const Event &event = ring->events[j & (capacity - 1)];
+                length = 0;
+                append(buffer, length, "  @");
+                append(buffer, length, event.time);
+                append(buffer, length, " ");
+                append(buffer, length, event.tag == nullptr ? "(null)" : event.tag);
+                append(buffer, length, " ");
+                append(buffer, length, event.a);
+                append(buffer, length, " ");
+                append(buffer, length, event.b);
+                append(buffer, length, "\n");
+                write_all(fd, buffer, length);
+            }
+        }
+    }
+
+    /// Dump the events on `SIGSEGV` and `SIGABRT`
+    [[maybe_unused]] static void install_signal_handlers() {
+        struct sigaction action = {};
+        action.sa_handler = signal_handler;
+        action.sa_flags = SA_RESETHAND | SA_NODEFER;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGSEGV, &action, nullptr);
+        sigaction(SIGABRT, &action, nullptr);
+    }
+};
+
+/// Record an event into the flight recorder (macro)
+#define flight_record(tag, ...) cherry::FlightRecorder::record(tag, ##__VA_ARGS__)
+
+/// An unimplemented error raiser
+[[noreturn]] [[maybe_unused]] static void unimplemented_impl(int line, const char *file) {
+    Sink::standard_output().flush();
+    std::fprintf(stderr, "Unimplemented part at line %d in file %s\n", line, file);
+    FlightRecorder::dump();
+    std::exit(EXIT_FAILURE);
+}
+
+/// An unimplemented error raiser (macro)
+#define unimplemented() cherry::unimplemented_impl(__LINE__, __FILE__)
+
+/// An unreachable error raiser
+[[noreturn]] [[maybe_unused]] static void unreachable_impl(int line, const char *file) {
+    Sink::standard_output().flush();
+    std::fprintf(stderr, "Unreachable part at line %d in file %s\n", line, file);
+    FlightRecorder::dump();
+    std::exit(EXIT_FAILURE);
+}
+
+/// An unreachable error raiser (macro)
+#define unreachable() cherry::unreachable_impl(__LINE__, __FILE__)
+
+/// Do nothing
+static inline void do_nothing() {
+    // Do nothing
+}
+
+/// Early exit (`info` goes to the standard output sink on success, otherwise to the standard error)
+[[noreturn]] [[maybe_unused]] static void early_exit(const std::string &info="", int exit_code=EXIT_FAILURE) {
+    if (exit_code == EXIT_SUCCESS) {
+        Sink::standard_output().print(info, '\n');
+        Sink::standard_output().flush();
+    } else {
+        Sink::standard_output().flush();
+        std::fprintf(stderr, "%s\n", info.c_str());
+        FlightRecorder::dump();
+    }
+    std::exit(exit_code);
+}
+
+} // namespace cherry
@@ -0,0 +1,268 @@
+/*
+ * Cherry: deduplication (unique, sort_unique and distinct)
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "algorithms.hpp"
+#include "ranges.hpp"
+
+namespace cherry {
+
+/// Skip the leading items equal to `value` in [`begin`, `end`) (SIMD for integers), return the first different one
+template <typename T>
+[[maybe_unused]] [[nodiscard]] static inline const T *skip_equal(const T *begin, const T *end, const T &value) {
+#if defined(__SSE2__)
+    if constexpr (std::is_integral<T>::value and 16 % sizeof(T) == 0) {
+        // Integers are equal if and only if their bytes are equal
+        constexpr size_t lanes = 16 / sizeof(T);
+        T pattern[lanes];
+        std::fill(pattern, pattern + lanes, value);
+        __m128i broadcast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern));
+        for (; end - begin >= static_cast<ptrdiff_t>(lanes); begin += lanes) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+            auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, broadcast)));
+            if (mask != 0xffffu) {
+                return begin + __builtin_ctz(~mask) / sizeof(T);
+            }
+        }
+    }
+#endif
+    while (begin != end and *begin == value) {
+        ++ begin;
+    }
+    return begin;
+}
+
+/// A lazy range of the distinct items of a sorted range (the first item of every run of equal items)
+template <typename Range>
+class [[maybe_unused]] UniqueRange {
+private:
+    const Range &range;
+
+public:
+    [[maybe_unused]] typedef typename Range::value_type value_type;
+    typedef typename Range::const_iterator range_iterator_t;
+
+    /// The iterator type for `UniqueRange`
+    struct [[maybe_unused]] Iterator {
+        range_iterator_t iterator, end;
+
+        [[maybe_unused]] Iterator(range_iterator_t iterator, range_iterator_t end): iterator(iterator), end(end) {}
+
+        [[maybe_unused]] decltype(auto) operator *() const {
+            return *iterator;
+        }
+
+        [[maybe_unused]] Iterator operator ++() {
+            if constexpr (is_contiguous_range<Range, value_type>::value and std::is_integral<value_type>::value) {
+                const value_type *pointer = &*iterator, *last = pointer + (end - iterator);
+                iterator += skip_equal(pointer + 1, last, *pointer) - pointer;
+            } else {
+                const value_type &value = *iterator;
+                for (++ iterator; iterator != end and *iterator == value; ++ iterator) {}
+            }
+            return *this;
+        }
+
+        [[maybe_unused]] bool operator ==(const Iterator &other) const {
+            return iterator == other.iterator;
+        }
+
+        [[maybe_unused]] bool operator !=(const Iterator &other) const {
+            return iterator != other.iterator;
+        }
+    };
+
+    typedef Iterator iterator;
+    typedef Iterator const_iterator;
+
+    [[maybe_unused]] explicit UniqueRange(const Range &range): range(range) {}
+
+    [[maybe_unused]] [[nodiscard]] const_iterator begin() const {
+        return const_iterator(range.begin(), range.end());
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator end() const {
+        return const_iterator(range.end(), range.end());
+    }
+};
+
+/// Return a lazy range of the distinct items of a sorted range
+template <typename Range>
+[[maybe_unused]] [[nodiscard]] UniqueRange<Range> unique(const Range &range) {
+    return UniqueRange<Range>(range);
+}
+
+/// Count the distinct items of a sorted range
+template <typename Range>
+[[maybe_unused]] [[nodiscard]] size_t count_unique(const Range &range) {
+    size_t count = 0;
+    for (auto iterator = unique(range).begin(), end = unique(range).end(); iterator != end; ++ iterator) {
+        ++ count;
+    }
+    return count;
+}
+
+/// Sort a vector and remove the duplicates in place, return the number of distinct items
+template <typename value_type>
+[[maybe_unused]] size_t sort_unique(std::vector<value_type> &vec) {
+    std::sort(vec.begin(), vec.end());
+    vec.erase(std::unique(vec.begin(), vec.end()), vec.end());
+    return vec.size();
+}
+
+/// Mix the bits of a hash (the finalizer of MurmurHash3), `std::hash` of integers is the identity
+[[maybe_unused]] [[nodiscard]] static inline uint64_t mix_hash(uint64_t hash) {
+    hash ^= hash >> 33u;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33u;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33u;
+    return hash;
+}
+
+/// An open-addressing hash set for distinct items, every item keeps the smallest position it is inserted with
+/// (the hash given at insertion is kept, so that growing places the items as they were inserted)
+template <typename T>
+class [[maybe_unused]] FlatHashSet {
+private:
+    struct Slot {
+        T value;
+        size_t position;
+        uint64_t hash;
+        bool used;
+    };
+
+    std::vector<Slot> slots;
+    size_t count = 0;
+
+    void grow() {
+        std::vector<Slot> old_slots(std::max<size_t>(16, slots.size() * 2));
+        std::swap(slots, old_slots);
+        count = 0;
+        for (const auto &slot: old_slots) {
+            if (slot.used) {
+                insert(slot.value, slot.position, slot.hash);
+            }
+        }
+    }
+
+public:
+    [[maybe_unused]] explicit FlatHashSet(size_t expected=0) {
+        size_t capacity = 16;
+        while (capacity * 3 < expected * 4) {
+            capacity *= 2;
+        }
+        slots.resize(capacity);
+    }
+
+    /// Insert an item with a pre-computed (mixed) hash, return whether it is new
+    [[maybe_unused]] bool insert(const T &value, size_t position, uint64_t hash) {
+        if ((count + 1) * 4 > slots.size() * 3) {
+            grow();
+        }
+        size_t mask = slots.size() - 1, index = hash & mask;
+        while (slots[index].used) {
+            if (slots[index].hash == hash and slots[index].value == value) {
+                slots[index].position = std::min(slots[index].position, position);
+                return false;
+            }
+            index = (index + 1) & mask;
+        }
+        slots[index] = {value, position, hash, true};
+        ++ count;
+        return true;
+    }
+
+    [[maybe_unused]] [[nodiscard]] size_t size() const {
+        return count;
+    }
+
+    /// Call `f(value, position)` for every item
+    template <typename Function>
+    [[maybe_unused]] void for_each(const Function &f) const {
+        for (const auto &slot: slots) {
+            if (slot.used) {
+                f(slot.value, slot.position);
+            }
+        }
+    }
+};
+
+/// Distinct items of any range, partitioned by hash across threads into per-thread flat tables
+/// (in the order of first occurrences if `keep_order`, otherwise in an unspecified order)
+template <typename Range, typename value_type = typename Range::value_type>
+[[maybe_unused]] [[nodiscard]] std::vector<value_type> distinct(const Range &range, bool keep_order=false,
+                                                                int threads=static_cast<int>(std::thread::hardware_concurrency())) {
+    std::vector<value_type> items;
+    for (const auto &item: range) {
+        items.push_back(item);
+    }
+    threads = std::max(1, std::min<int>(threads, static_cast<int>(items.size() / 16384) + 1));
+
+    // Scatter the positions into (thread, partition) buckets, then every thread builds the table of a partition
+    std::vector<std::vector<std::vector<size_t>>> buckets(threads, std::vector<std::vector<size_t>>(threads));
+    std::vector<FlatHashSet<value_type>> tables;
+    for (int i = 0; i < threads; ++ i) {
+        tables.emplace_back(items.size() / threads);
+    }
+    auto run = [threads](const std::function<void(int)> &task) {
+        std::vector<std::thread> workers;
+        for (int i = 1; i < threads; ++ i) {
+            workers.emplace_back(task, i);
+        }
+        task(0);
+        for (auto &worker: workers) {
+            worker.join();
+        }
+    };
+    run([&](int t) {
+        size_t begin = items.size() * t / threads, end = items.size() * (t + 1) / threads;
+        for (size_t i = begin; i < end; ++ i) {
+            buckets[t][mix_hash(std::hash<value_type>()(items[i])) % threads].push_back(i);
+        }
+    });
+    run([&](int p) {
+        for (int t = 0; t < threads; ++ t) {
+            for (const auto &i: buckets[t][p]) {
+                tables[p].insert(items[i], i, mix_hash(std::hash<value_type>()(items[i])) / threads);
+            }
+        }
+    });
+
+    std::vector<std::pair<size_t, value_type>> found;
+    for (const auto &table: tables) {
+        table.for_each([&found](const value_type &value, size_t position) {
+            found.emplace_back(position, value);
+        });
+    }
+    if (keep_order) {
+        std::sort(found.begin(), found.end(), [](const auto &a, const auto &b) -> bool {
+            return a.first < b.first;
+        });
+    }
+    return map(found, [](const std::pair<size_t, value_type> &pair) -> value_type {
+        return pair.second;
+    });
+}
+
+/// Count the distinct items of any range (parallel and hash-based)
+template <typename Range>
+[[maybe_unused]] [[nodiscard]] size_t count_distinct(const Range &range,
+                                                     int threads=static_cast<int>(std::thread::hardware_concurrency())) {
+    return distinct(range, false, threads).size();
+}
+
+} // namespace cherry
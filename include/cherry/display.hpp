@@ -0,0 +1,29 @@
+/*
+ * Cherry: display switches of output streams
+ */
+
+#pragma once
+
+#include <iostream>
+
+#include "sink.hpp"
+
+namespace cherry {
+
+/// Disable display (`std::cout` also disables `Sink::standard_output()`)
+static inline void disable_display(std::ostream& os=std::cout) {
+    os.setstate(std::ios::failbit);
+    if (&os == &std::cout) {
+        Sink::standard_output().enable(false);
+    }
+}
+
+/// Restore display (`std::cout` also enables `Sink::standard_output()`)
+static inline void restore_display(std::ostream& os=std::cout) {
+    os.clear();
+    if (&os == &std::cout) {
+        Sink::standard_output().enable();
+    }
+}
+
+} // namespace cherry
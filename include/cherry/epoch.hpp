@@ -0,0 +1,161 @@
+/*
+ * Cherry: epoch-based memory reclamation for lock-free structures
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cherry {
+
+/// Epoch-based reclamation: readers pin the global epoch while they hold pointers, and an unlinked object retired
+/// at epoch `e` is freed once the global epoch reaches `e + 2`, when no pinned reader can still see it
+class [[maybe_unused]] EpochManager {
+private:
+    struct Retired {
+        void *pointer;
+        void (*deleter)(void*);
+        uint64_t epoch;
+    };
+
+    // A pinning slot, owned by one guard at a time (with the objects retired through it and the state of collecting)
+    struct alignas(64) Slot {
+        std::atomic<bool> active = false;
+        std::atomic<uint64_t> epoch = 0;
+        std::vector<Retired> retired;
+        uint64_t collected_epoch = 0;
+        size_t next_collect = collect_threshold;
+    };
+
+    static constexpr size_t slots_count = 128, collect_threshold = 64;
+
+    std::atomic<uint64_t> global = 1;
+    Slot slots[slots_count];
+
+    // Advance the global epoch if every pinned slot has seen the current one
+    void try_advance() {
+        uint64_t epoch = global.load();
+        for (const auto &slot: slots) {
+            if (slot.active.load() and slot.epoch.load() != epoch) {
+                return;
+            }
+        }
+        global.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+    void collect(Slot &slot) {
+        uint64_t epoch = global.load();
+        size_t kept = 0;
+        for (auto &retired: slot.retired) {
+            if (retired.epoch + 2 <= epoch) {
+                retired.deleter(retired.pointer);
+            } else {
+                slot.retired[kept ++] = retired;
+            }
+        }
+        slot.retired.resize(kept);
+    }
+
+public:
+    /// Keeps the epoch pinned while alive, retired objects are freed after all the guards of their epoch
+    class [[maybe_unused]] Guard {
+    private:
+        friend class EpochManager;
+
+        EpochManager *manager;
+        Slot *slot;
+
+        Guard(EpochManager *manager, Slot *slot): manager(manager), slot(slot) {}
+
+    public:
+        Guard(const Guard &) = delete;
+
+        Guard &operator =(const Guard &) = delete;
+
+        [[maybe_unused]] Guard(Guard &&other) noexcept: manager(other.manager), slot(other.slot) {
+            other.slot = nullptr;
+        }
+
+        ~Guard() {
+            if (slot != nullptr) {
+                slot->epoch.store(0, std::memory_order_release);
+                slot->active.store(false, std::memory_order_release);
+            }
+        }
+
+        /// Free `pointer` by `deleter` when no reader can see it (it must be unlinked already)
+        [[maybe_unused]] void retire(void *pointer, void (*deleter)(void*)) {
+            slot->retired.push_back({pointer, deleter, manager->global.load()});
+            // Every `collect_threshold` retirements, and the objects are only scanned again once the epoch moved
+            // (a stalled epoch costs no rescans)
+            if (slot->retired.size() >= slot->next_collect) {
+                manager->try_advance();
+                uint64_t epoch = manager->global.load();
+                if (epoch != slot->collected_epoch) {
+                    manager->collect(*slot);
+                    slot->collected_epoch = epoch;
+                }
+                slot->next_collect = slot->retired.size() + collect_threshold;
+            }
+        }
+
+        /// Retire an object created by `new`
+        template <typename T>
+        [[maybe_unused]] void retire(T *object) {
+            retire(object, [](void *pointer) {
+                delete static_cast<T*>(pointer);
+            });
+        }
+    };
+
+    EpochManager() = default;
+
+    EpochManager(const EpochManager &) = delete;
+
+    EpochManager &operator =(const EpochManager &) = delete;
+
+    /// Free all the retired objects (no guard may be alive)
+    ~EpochManager() {
+        for (auto &slot: slots) {
+            for (auto &retired: slot.retired) {
+                retired.deleter(retired.pointer);
+            }
+        }
+    }
+
+    /// Pin the current epoch (a free slot is found at once unless `slots_count` guards are alive, then it yields)
+    [[maybe_unused]] Guard pin() {
+        // Threads start probing at different slots
+        static thread_local size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+        for (size_t i = hint; ; ++ i) {
+            if (i != hint and (i - hint) % slots_count == 0) {
+                // All the slots are taken, let their guards go
+                std::this_thread::yield();
+            }
+            Slot &slot = slots[i % slots_count];
+            if (not slot.active.load(std::memory_order_relaxed) and not slot.active.exchange(true, std::memory_order_acquire)) {
+                hint = i;
+                // The pinned epoch must be visible before reading the global epoch again
+                uint64_t epoch;
+                do {
+                    epoch = global.load();
+                    slot.epoch.store(epoch);
+                } while (global.load() != epoch);
+                return Guard(this, &slot);
+            }
+        }
+    }
+
+    /// The global epoch
+    [[maybe_unused]] [[nodiscard]] uint64_t epoch() const {
+        return global.load();
+    }
+};
+
+} // namespace cherry
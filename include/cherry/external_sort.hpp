@@ -0,0 +1,443 @@
+/*
+ * Cherry: external-memory merge sort of fixed-size records
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+#include "sort.hpp"
+#include "units.hpp"
+
+namespace cherry {
+
+/// A loser tree selecting the minimum of `k` sources with `log2(k)` comparisons per item,
+/// `less(i, j)` compares the current items of sources `i` and `j` (exhausted sources are the largest)
+template <typename Less>
+class [[maybe_unused]] LoserTree {
+private:
+    size_t k;
+    std::vector<size_t> tree;
+    Less less;
+
+    size_t build(size_t node) {
+        if (node >= k) {
+            return node - k;
+        }
+        size_t left = build(node * 2), right = build(node * 2 + 1);
+        bool right_wins = less(right, left);
+        tree[node] = right_wins ? left : right;
+        return right_wins ? right : left;
+    }
+
+public:
+    [[maybe_unused]] LoserTree(size_t k, const Less &less): k(k), tree(std::max<size_t>(k, 1)), less(less) {
+        if (k > 0) {
+            tree[0] = build(1);
+        }
+    }
+
+    /// The source with the minimum item
+    [[maybe_unused]] [[nodiscard]] size_t winner() const {
+        return tree[0];
+    }
+
+    /// Replay the matches of the winner after its source advanced
+    [[maybe_unused]] void replay() {
+        size_t winner = tree[0];
+        for (size_t node = (winner + k) / 2; node >= 1; node /= 2) {
+            if (less(tree[node], winner)) {
+                std::swap(tree[node], winner);
+            }
+        }
+        tree[0] = winner;
+    }
+};
+
+/// Read all the requested bytes unless the file ends, return the bytes read (-1 if failed)
+[[maybe_unused]] static inline ssize_t read_fully(int fd, void *buffer, size_t bytes) {
+    size_t total = 0;
+    while (total < bytes) {
+        ssize_t count = read(fd, static_cast<char*>(buffer) + total, bytes - total);
+        if (count < 0) {
+            return -1;
+        } else if (count == 0) {
+            break;
+        }
+        total += count;
+    }
+    return static_cast<ssize_t>(total);
+}
+
+/// Write all the bytes, return whether succeeded
+[[maybe_unused]] static inline bool write_fully(int fd, const void *buffer, size_t bytes) {
+    size_t total = 0;
+    while (total < bytes) {
+        ssize_t count = write(fd, static_cast<const char*>(buffer) + total, bytes - total);
+        if (count <= 0) {
+            return false;
+        }
+        total += count;
+    }
+    return true;
+}
+
+/// A streaming reader of fixed-size records in chunks, the next chunk is hinted to the kernel for read-ahead
+template <typename T>
+class [[maybe_unused]] RecordReader {
+private:
+    int fd = -1;
+    off_t offset = 0;
+    std::vector<T> buffer;
+    size_t position = 0, count = 0;
+    bool failed = false;
+
+    bool refill() {
+        ssize_t bytes = read_fully(fd, buffer.data(), buffer.size() * sizeof(T));
+        if (bytes < 0 or bytes % sizeof(T) != 0) {
+            failed = true;
+            bytes = 0;
+        }
+        offset += bytes;
+        position = 0, count = bytes / sizeof(T);
+        if (count > 0) {
+            posix_fadvise(fd, offset, static_cast<off_t>(buffer.size() * sizeof(T)), POSIX_FADV_WILLNEED);
+        }
+        return count > 0;
+    }
+
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "Records must be trivially copyable");
+
+    /// Open a file with a buffer of `chunk` records
+    [[maybe_unused]] RecordReader(const std::string &path, size_t chunk): buffer(std::max<size_t>(chunk, 1)) {
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::fprintf(stderr, "Failed to open file %s\n", path.c_str());
+            failed = true;
+            return;
+        }
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        refill();
+    }
+
+    RecordReader(const RecordReader &) = delete;
+
+    RecordReader &operator =(const RecordReader &) = delete;
+
+    [[maybe_unused]] ~RecordReader() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    /// Whether all the records are consumed
+    [[maybe_unused]] [[nodiscard]] bool exhausted() const {
+        return position == count;
+    }
+
+    /// Whether opening or reading failed
+    [[maybe_unused]] [[nodiscard]] bool fail() const {
+        return failed;
+    }
+
+    /// The current record
+    [[maybe_unused]] [[nodiscard]] const T &current() const {
+        return buffer[position];
+    }
+
+    /// Move to the next record, return whether there is one
+    [[maybe_unused]] bool advance() {
+        return ++ position < count or refill();
+    }
+
+    /// Read up to `n` records into `items` (the buffered ones first), return the number read
+    [[maybe_unused]] size_t read(T *items, size_t n) {
+        size_t total = 0;
+        while (total < n and (position < count or refill())) {
+            size_t copied = std::min(n - total, count - position);
+            std::copy(buffer.data() + position, buffer.data() + position + copied, items + total);
+            position += copied, total += copied;
+        }
+        return total;
+    }
+};
+
+/// A writer of fixed-size records with large sequential writes
+template <typename T>
+class [[maybe_unused]] RecordWriter {
+private:
+    int fd = -1;
+    std::vector<T> buffer;
+    size_t count = 0;
+    bool failed = false;
+
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "Records must be trivially copyable");
+
+    /// Create (or truncate) a file with a buffer of `chunk` records
+    [[maybe_unused]] RecordWriter(const std::string &path, size_t chunk): buffer(std::max<size_t>(chunk, 1)) {
+        fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::fprintf(stderr, "Failed to create file %s\n", path.c_str());
+            failed = true;
+        }
+    }
+
+    RecordWriter(const RecordWriter &) = delete;
+
+    RecordWriter &operator =(const RecordWriter &) = delete;
+
+    [[maybe_unused]] ~RecordWriter() {
+        close();
+    }
+
+    /// Whether opening or writing failed
+    [[maybe_unused]] [[nodiscard]] bool fail() const {
+        return failed;
+    }
+
+    /// Append a record
+    [[maybe_unused]] void push(const T &item) {
+        buffer[count ++] = item;
+        if (count == buffer.size()) {
+            flush();
+        }
+    }
+
+    /// Write the buffered records
+    [[maybe_unused]] void flush() {
+        if (count > 0 and fd >= 0 and not write_fully(fd, buffer.data(), count * sizeof(T))) {
+            failed = true;
+        }
+        count = 0;
+    }
+
+    /// Flush and close the file, return whether all the records are written
+    [[maybe_unused]] bool close() {
+        if (fd >= 0) {
+            flush();
+            ::close(fd);
+            fd = -1;
+        }
+        return not failed;
+    }
+};
+
+/// Progress of an external sort, `phase` is "run" (sorting runs) or "merge"
+struct [[maybe_unused]] ExternalSortProgress {
+    const char *phase;
+    size_t processed_bytes, total_bytes, runs;
+};
+
+/// Options of an external sort
+struct [[maybe_unused]] ExternalSortOptions {
+    /// Memory for records (runs are half of it, the other half is the radix sort scratch)
+    size_t memory_budget = Unit::GiB(1);
+    /// Threads sorting a run in memory
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    /// Directory of the temporary runs (the directory of the output by default, i.e. the same disk)
+    std::string temp_directory;
+    /// Bytes of every sequential read and write
+    size_t io_chunk = Unit::MiB(8);
+    /// Called after every run and every `io_chunk * 8` merged bytes
+    std::function<void(const ExternalSortProgress&)> progress;
+};
+
+/// Run files of all the sorters in a process are numbered by one counter, so that their names never collide
+inline std::atomic<uint64_t> external_run_counter{0};
+
+/// An external merge sort of fixed-size records by `key` for files larger than the memory: runs are sorted
+/// in memory (by threads, radix sort for integer keys), spilled, and merged by loser trees with read-ahead
+template <typename T, typename KeyFunction = IdentityKey>
+class [[maybe_unused]] ExternalSorter {
+private:
+    ExternalSortOptions options;
+    KeyFunction key;
+    std::vector<std::string> runs;
+    size_t total_bytes = 0, processed_bytes = 0;
+
+    void report(const char *phase) {
+        if (options.progress) {
+            options.progress({phase, processed_bytes, total_bytes, runs.size()});
+        }
+    }
+
+    [[nodiscard]] std::string run_path() {
+        return options.temp_directory + "/cherry_run_" + std::to_string(getpid()) + "_" +
+               std::to_string(external_run_counter.fetch_add(1, std::memory_order_relaxed));
+    }
+
+    /// Sort slices in parallel (the slices of one thread each), return the slice boundaries
+    std::vector<size_t> sort_slices(T *items, T *scratch, size_t n) {
+        size_t threads = std::max<size_t>(1, std::min<size_t>(options.threads, n / 4096 + 1));
+        std::vector<size_t> bounds(threads + 1);
+        for (size_t i = 0; i <= threads; ++ i) {
+            bounds[i] = n * i / threads;
+        }
+        auto task = [&](size_t i) {
+            size_t begin = bounds[i], length = bounds[i + 1] - bounds[i];
+            if constexpr (std::is_integral<typename std::decay<decltype(key(*items))>::type>::value) {
+                radix_sort(items + begin, scratch + begin, length, key);
+            } else {
+                std::sort(items + begin, items + begin + length, [this](const T &a, const T &b) -> bool {
+                    return key(a) < key(b);
+                });
+            }
+        };
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < threads; ++ i) {
+            workers.emplace_back(task, i);
+        }
+        task(0);
+        for (auto &worker: workers) {
+            worker.join();
+        }
+        return bounds;
+    }
+
+    /// Merge sources (with `exhausted(i)`, `current(i)` and `advance(i)`) into a writer
+    template <typename Exhausted, typename Current, typename Advance>
+    void merge(size_t k, const Exhausted &exhausted, const Current &current, const Advance &advance,
+               RecordWriter<T> &writer, bool reporting) {
+        auto less = [&](size_t i, size_t j) -> bool {
+            if (exhausted(i)) {
+                return false;
+            }
+            return exhausted(j) or key(current(i)) < key(current(j));
+        };
+        LoserTree<decltype(less)> tree(k, less);
+        size_t report_interval = std::max<size_t>(options.io_chunk * 8 / sizeof(T), 1), merged = 0;
+        while (k > 0 and not exhausted(tree.winner())) {
+            size_t winner = tree.winner();
+            writer.push(current(winner));
+            advance(winner);
+            tree.replay();
+            if (reporting and ++ merged % report_interval == 0) {
+                processed_bytes += report_interval * sizeof(T);
+                report("merge");
+            }
+        }
+        if (reporting) {
+            processed_bytes += (merged % report_interval) * sizeof(T);
+        }
+    }
+
+    /// Merge run files into a file, return whether succeeded
+    bool merge_runs(const std::vector<std::string> &paths, const std::string &output, bool reporting) {
+        size_t chunk = std::max<size_t>(options.memory_budget / (paths.size() + 1) / sizeof(T), 1);
+        std::vector<std::unique_ptr<RecordReader<T>>> readers;
+        for (const auto &path: paths) {
+            readers.push_back(std::make_unique<RecordReader<T>>(path, chunk));
+            if (readers.back()->fail()) {
+                return false;
+            }
+        }
+        RecordWriter<T> writer(output, chunk);
+        merge(readers.size(), [&readers](size_t i) -> bool {
+            return readers[i]->exhausted();
+        }, [&readers](size_t i) -> const T& {
+            return readers[i]->current();
+        }, [&readers](size_t i) {
+            readers[i]->advance();
+        }, writer, reporting);
+        return writer.close() and std::none_of(readers.begin(), readers.end(), [](const auto &reader) -> bool {
+            return reader->fail();
+        });
+    }
+
+    void remove_runs(size_t count) {
+        for (size_t i = 0; i < count; ++ i) {
+            unlink(runs[i].c_str());
+        }
+        runs.erase(runs.begin(), runs.begin() + static_cast<ptrdiff_t>(count));
+    }
+
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "Records must be trivially copyable");
+
+    [[maybe_unused]] explicit ExternalSorter(ExternalSortOptions options = {}, const KeyFunction &key = KeyFunction()):
+            options(std::move(options)), key(key) {}
+
+    /// Sort the records of `input` into `output`, return whether succeeded
+    [[maybe_unused]] bool sort(const std::string &input, const std::string &output) {
+        struct stat status = {};
+        if (stat(input.c_str(), &status) != 0 or status.st_size % sizeof(T) != 0) {
+            std::fprintf(stderr, "Failed to sort %s (missing, or not made of %zu-byte records)\n", input.c_str(), sizeof(T));
+            return false;
+        }
+        if (options.temp_directory.empty()) {
+            auto slash = output.find_last_of('/');
+            options.temp_directory = slash == std::string::npos ? "." : output.substr(0, slash);
+        }
+        total_bytes = status.st_size, processed_bytes = 0;
+        size_t io_records = std::max<size_t>(options.io_chunk / sizeof(T), 1);
+
+        // Sort runs of half of the budget (the other half is scratch), merging the sorted slices while spilling
+        size_t run_records = std::max<size_t>(options.memory_budget / 2 / sizeof(T), 1);
+        bool succeeded = true;
+        {
+            RecordReader<T> reader(input, io_records);
+            std::vector<T> items(std::min<size_t>(run_records, total_bytes / sizeof(T))), scratch(items.size());
+            size_t n;
+            while (succeeded and (n = reader.read(items.data(), items.size())) > 0) {
+                auto bounds = sort_slices(items.data(), scratch.data(), n);
+                runs.push_back(run_path());
+                RecordWriter<T> writer(runs.back(), io_records);
+                std::vector<size_t> positions(bounds.begin(), bounds.end() - 1);
+                merge(positions.size(), [&](size_t i) -> bool {
+                    return positions[i] == bounds[i + 1];
+                }, [&](size_t i) -> const T& {
+                    return items[positions[i]];
+                }, [&](size_t i) {
+                    ++ positions[i];
+                }, writer, false);
+                succeeded = writer.close();
+                processed_bytes += n * sizeof(T);
+                report("run");
+            }
+            succeeded = succeeded and not reader.fail();
+        }
+
+        // Merge with a fan-in leaving every run a buffer of at least `io_chunk`, extra passes if there are more runs
+        size_t fan_in = std::max<size_t>(2, options.memory_budget / std::max<size_t>(options.io_chunk, 1) - 1);
+        processed_bytes = 0;
+        while (succeeded and runs.size() > fan_in) {
+            auto path = run_path();
+            succeeded = merge_runs(std::vector<std::string>(runs.begin(), runs.begin() + static_cast<ptrdiff_t>(fan_in)), path, false);
+            remove_runs(fan_in);
+            runs.push_back(path);
+        }
+        if (succeeded) {
+            succeeded = merge_runs(runs, output, true);
+            report("merge");
+        }
+        remove_runs(runs.size());
+        if (not succeeded) {
+            std::fprintf(stderr, "Failed to sort %s into %s\n", input.c_str(), output.c_str());
+        }
+        return succeeded;
+    }
+};
+
+/// Sort the fixed-size records of file `input` into file `output` by `key`, return whether succeeded
+template <typename T, typename KeyFunction = IdentityKey>
+[[maybe_unused]] bool external_sort(const std::string &input, const std::string &output,
+                                    const ExternalSortOptions &options = {}, const KeyFunction &key = KeyFunction()) {
+    return ExternalSorter<T, KeyFunction>(options, key).sort(input, output);
+}
+
+} // namespace cherry
@@ -0,0 +1,190 @@
+/*
+ * Cherry: coroutine generators (C++20)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+
+namespace cherry {
+
+#ifdef CHERRY_COROUTINES
+
+/// A thread-local pool recycling coroutine frames by 64-byte size classes
+class [[maybe_unused]] CoroutineFramePool {
+private:
+    static constexpr size_t granularity = 64;
+    static constexpr size_t classes = 16;
+
+    struct Node {
+        Node *next;
+    };
+
+    Node *free_lists[classes] = {};
+
+public:
+    ~CoroutineFramePool() {
+        for (auto &head: free_lists) {
+            while (head != nullptr) {
+                Node *next = head->next;
+                ::operator delete(head);
+                head = next;
+            }
+        }
+    }
+
+    /// The pool of the current thread
+    [[nodiscard]] static CoroutineFramePool &local() {
+        thread_local CoroutineFramePool pool;
+        return pool;
+    }
+
+    [[nodiscard]] void *allocate(size_t size) {
+        size_t index = (size - 1) / granularity;
+        if (index >= classes) {
+            return ::operator new(size);
+        }
+        if (Node *head = free_lists[index]) {
+            free_lists[index] = head->next;
+            return head;
+        }
+        return ::operator new((index + 1) * granularity);
+    }
+
+    void deallocate(void *pointer, size_t size) {
+        size_t index = (size - 1) / granularity;
+        if (index >= classes) {
+            ::operator delete(pointer);
+            return;
+        }
+        auto node = static_cast<Node*>(pointer);
+        node->next = free_lists[index];
+        free_lists[index] = node;
+    }
+};
+
+/// A lazy range produced by a coroutine (`co_yield`), requires C++20
+template <typename T>
+class [[maybe_unused]] Generator {
+public:
+    [[maybe_unused]] typedef typename std::remove_cv<typename std::remove_reference<T>::type>::type value_type;
+    typedef typename std::conditional<std::is_reference<T>::value, T, const value_type&>::type reference;
+    typedef typename std::remove_reference<reference>::type *pointer;
+
+    /// The promise type for `Generator`, frames are allocated from `CoroutineFramePool`
+    struct promise_type {
+        pointer current = nullptr;
+        std::exception_ptr exception;
+
+        static void *operator new(size_t size) {
+            return CoroutineFramePool::local().allocate(size);
+        }
+
+        static void operator delete(void *pointer, size_t size) {
+            CoroutineFramePool::local().deallocate(pointer, size);
+        }
+
+        Generator get_return_object() {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_always yield_value(typename std::remove_reference<reference>::type &value) noexcept {
+            current = std::addressof(value);
+            return {};
+        }
+
+        /// Yielding a temporary is safe, it lives until the coroutine resumes
+        std::suspend_always yield_value(value_type &&value) noexcept {
+            current = std::addressof(value);
+            return {};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() {
+            exception = std::current_exception();
+        }
+    };
+
+    typedef std::coroutine_handle<promise_type> handle_t;
+
+    /// The iterator type for `Generator` (input iterator)
+    struct [[maybe_unused]] Iterator {
+        handle_t handle;
+
+        [[maybe_unused]] explicit Iterator(handle_t handle): handle(handle) {}
+
+        [[maybe_unused]] reference operator *() const {
+            return static_cast<reference>(*handle.promise().current);
+        }
+
+        [[maybe_unused]] Iterator &operator ++() {
+            handle.resume();
+            if (handle.done() and handle.promise().exception) {
+                std::rethrow_exception(handle.promise().exception);
+            }
+            return *this;
+        }
+
+        [[maybe_unused]] bool operator ==(const Iterator &other) const {
+            return (handle == nullptr or handle.done()) == (other.handle == nullptr or other.handle.done());
+        }
+
+        [[maybe_unused]] bool operator !=(const Iterator &other) const {
+            return not (*this == other);
+        }
+    };
+
+    typedef Iterator iterator;
+    typedef Iterator const_iterator;
+
+private:
+    handle_t handle;
+
+    explicit Generator(handle_t handle): handle(handle) {}
+
+public:
+    [[maybe_unused]] Generator(Generator &&other) noexcept: handle(std::exchange(other.handle, nullptr)) {}
+
+    Generator(const Generator &) = delete;
+
+    Generator &operator =(const Generator &) = delete;
+
+    [[maybe_unused]] ~Generator() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    /// Start (or continue) the coroutine, a generator can only be iterated once
+    [[maybe_unused]] [[nodiscard]] iterator begin() const {
+        Iterator iterator(handle);
+        if (handle and not handle.done() and handle.promise().current == nullptr) {
+            ++ iterator;
+        }
+        return iterator;
+    }
+
+    [[maybe_unused]] [[nodiscard]] iterator end() const {
+        return Iterator(nullptr);
+    }
+};
+
+#endif
+
+} // namespace cherry
@@ -0,0 +1,231 @@
+/*
+ * Cherry: Sobol and Halton low-discrepancy sequences
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace cherry {
+
+/// A Sobol low-discrepancy sequence generator (Joe-Kuo direction numbers, Gray-code order)
+template <typename value_type=double>
+class [[maybe_unused]] Sobol {
+private:
+    static_assert(std::is_floating_point<value_type>::value, "Sobol points must be floating-point");
+
+    static constexpr int bits = 32;
+
+    /// Primitive polynomials (degree `s`, middle coefficients `a`) and initial numbers `m` for dimensions 2 to 64,
+    /// taken from the `new-joe-kuo-6.21201` file by S. Joe and F. Y. Kuo
+    struct DirectionNumbers {
+        int s;
+        uint32_t a;
+        uint32_t m[9];
+    };
+
+    [[nodiscard]] static const DirectionNumbers &joe_kuo(int dimension) {
+        static constexpr DirectionNumbers table[] = {
+            {1, 0, {1}}, {2, 1, {1, 3}},
+            {3, 1, {1, 3, 1}}, {3, 2, {1, 1, 1}},
+            {4, 1, {1, 1, 3, 3}}, {4, 4, {1, 3, 5, 13}},
+            {5, 2, {1, 1, 5, 5, 17}}, {5, 4, {1, 1, 5, 5, 5}},
+            {5, 7, {1, 1, 7, 11, 19}}, {5, 11, {1, 1, 5, 1, 1}},
+            {5, 13, {1, 1, 1, 3, 11}}, {5, 14, {1, 3, 5, 5, 31}},
+            {6, 1, {1, 3, 3, 9, 7, 49}}, {6, 13, {1, 1, 1, 15, 21, 21}},
+            {6, 16, {1, 3, 1, 13, 27, 49}}, {6, 19, {1, 1, 1, 15, 7, 5}},
+            {6, 22, {1, 3, 1, 15, 13, 25}}, {6, 25, {1, 1, 5, 5, 19, 61}},
+            {7, 1, {1, 3, 7, 11, 23, 15, 103}}, {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+            {7, 7, {1, 1, 3, 13, 7, 35, 63}}, {7, 8, {1, 3, 5, 9, 1, 25, 53}},
+            {7, 14, {1, 3, 1, 13, 9, 35, 107}}, {7, 19, {1, 3, 1, 5, 27, 61, 31}},
+            {7, 21, {1, 1, 5, 11, 19, 41, 61}}, {7, 28, {1, 3, 5, 3, 3, 13, 69}},
+            {7, 31, {1, 1, 7, 13, 1, 19, 1}}, {7, 32, {1, 3, 7, 5, 13, 19, 59}},
+            {7, 37, {1, 1, 3, 9, 25, 29, 41}}, {7, 41, {1, 3, 5, 13, 23, 1, 55}},
+            {7, 42, {1, 3, 7, 3, 13, 59, 17}}, {7, 50, {1, 3, 1, 3, 5, 53, 69}},
+            {7, 55, {1, 1, 5, 5, 23, 33, 13}}, {7, 56, {1, 1, 7, 7, 1, 61, 123}},
+            {7, 59, {1, 1, 7, 9, 13, 61, 49}}, {7, 62, {1, 3, 3, 5, 3, 55, 33}},
+            {8, 14, {1, 3, 1, 15, 31, 13, 49, 245}}, {8, 21, {1, 3, 5, 15, 31, 59, 63, 97}},
+            {8, 22, {1, 3, 1, 11, 11, 11, 77, 249}}, {8, 38, {1, 3, 1, 11, 27, 43, 71, 9}},
+            {8, 47, {1, 1, 7, 15, 21, 11, 81, 45}}, {8, 49, {1, 3, 7, 3, 25, 31, 65, 79}},
+            {8, 50, {1, 3, 1, 1, 19, 11, 3, 205}}, {8, 52, {1, 1, 5, 9, 19, 21, 29, 157}},
+            {8, 56, {1, 3, 7, 11, 1, 33, 89, 185}}, {8, 67, {1, 3, 3, 3, 15, 9, 79, 71}},
+            {8, 70, {1, 3, 7, 11, 15, 39, 119, 27}}, {8, 84, {1, 1, 3, 1, 11, 31, 97, 225}},
+            {8, 97, {1, 1, 1, 3, 23, 43, 57, 177}}, {8, 103, {1, 3, 7, 7, 17, 17, 37, 71}},
+            {8, 115, {1, 3, 1, 5, 27, 63, 123, 213}}, {8, 122, {1, 1, 3, 5, 11, 43, 53, 133}},
+            {9, 8, {1, 3, 5, 5, 29, 17, 47, 173, 479}}, {9, 13, {1, 3, 3, 11, 3, 1, 109, 9, 69}},
+            {9, 16, {1, 1, 1, 5, 17, 39, 23, 5, 343}}, {9, 22, {1, 3, 1, 5, 25, 15, 31, 103, 499}},
+            {9, 25, {1, 1, 1, 11, 11, 17, 63, 105, 183}}, {9, 44, {1, 1, 5, 11, 9, 29, 97, 231, 363}},
+            {9, 47, {1, 1, 5, 15, 19, 45, 41, 7, 383}}, {9, 52, {1, 3, 7, 7, 31, 19, 83, 137, 221}},
+            {9, 55, {1, 1, 1, 3, 23, 15, 111, 223, 83}}, {9, 59, {1, 1, 5, 13, 31, 15, 55, 25, 161}},
+            {9, 62, {1, 1, 3, 13, 25, 47, 39, 87, 257}}
+        };
+        return table[dimension - 1];
+    }
+
+    int dimensions;
+    value_type min, scale;
+    uint64_t count = 0;
+    std::vector<uint32_t> directions, state;
+    std::vector<value_type> point;
+
+public:
+    /// Max dimensions supported by the embedded table
+    [[maybe_unused]] static constexpr int max_dimensions = 64;
+
+    /// Every coordinate is scaled into [`min`, `max`)
+    [[maybe_unused]] explicit Sobol(int dimensions, value_type min=0, value_type max=1):
+            dimensions(dimensions), min(min), scale(max - min) {
+        assert(dimensions > 0 and dimensions <= max_dimensions and min <= max);
+        directions.resize(dimensions * bits);
+        state.resize(dimensions, 0);
+        point.resize(dimensions);
+        for (int k = 0; k < bits; ++ k) {
+            directions[k] = 1u << (bits - 1 - k);
+        }
+        for (int j = 1; j < dimensions; ++ j) {
+            const auto &numbers = joe_kuo(j);
+            uint32_t *v = directions.data() + j * bits;
+            for (int k = 0; k < numbers.s; ++ k) {
+                v[k] = numbers.m[k] << (bits - 1 - k);
+            }
+            for (int k = numbers.s; k < bits; ++ k) {
+                v[k] = v[k - numbers.s] ^ (v[k - numbers.s] >> numbers.s);
+                for (int l = 1; l < numbers.s; ++ l) {
+                    v[k] ^= ((numbers.a >> (numbers.s - 1 - l)) & 1u) * v[k - l];
+                }
+            }
+        }
+    }
+
+    /// Generate the next point (O(dimensions), the first point is the origin)
+    [[maybe_unused]] const std::vector<value_type> &operator ()() {
+        for (int j = 0; j < dimensions; ++ j) {
+            point[j] = min + scale * static_cast<value_type>(std::ldexp(static_cast<double>(state[j]), -bits));
+        }
+        // Gray code: the next point differs in the direction of the lowest zero bit of the index
+        int c = __builtin_ctzll(~count);
+        assert(c < bits);
+        for (int j = 0; j < dimensions; ++ j) {
+            state[j] ^= directions[j * bits + c];
+        }
+        ++ count;
+        return point;
+    }
+
+    /// Fill `points` points into a contiguous buffer (row-major, `points * dimensions` values)
+    [[maybe_unused]] void fill(value_type *buffer, size_t points) {
+        for (size_t i = 0; i < points; ++ i) {
+            const auto &next = (*this)();
+            std::copy(next.begin(), next.end(), buffer + i * dimensions);
+        }
+    }
+
+    /// Jump to the point at `index` (O(dimensions * bits)), e.g. for partitioning the sequence among threads
+    [[maybe_unused]] void skip_to(uint64_t index) {
+        assert(index < (1ull << bits));
+        count = index;
+        uint64_t gray = index ^ (index >> 1u);
+        for (int j = 0; j < dimensions; ++ j) {
+            state[j] = 0;
+            for (int k = 0; k < bits; ++ k) {
+                if ((gray >> k) & 1u) {
+                    state[j] ^= directions[j * bits + k];
+                }
+            }
+        }
+    }
+
+    /// Index of the next point
+    [[maybe_unused]] [[nodiscard]] uint64_t index() const {
+        return count;
+    }
+};
+
+/// A (randomly digit-permuted) Halton low-discrepancy sequence generator
+template <typename value_type=double>
+class [[maybe_unused]] Halton {
+private:
+    static_assert(std::is_floating_point<value_type>::value, "Halton points must be floating-point");
+
+    int dimensions;
+    value_type min, scale;
+    uint64_t count = 0;
+    std::vector<uint32_t> bases;
+    // Digit permutations of every dimension, the digit 0 is always kept
+    std::vector<std::vector<uint32_t>> permutations;
+    std::vector<value_type> point;
+
+    [[nodiscard]] double radical_inverse(int dimension, uint64_t index) const {
+        uint32_t base = bases[dimension];
+        const auto &permutation = permutations[dimension];
+        double inverse_base = 1.0 / base, factor = inverse_base, result = 0;
+        while (index > 0) {
+            result += permutation[index % base] * factor;
+            index /= base, factor *= inverse_base;
+        }
+        return result;
+    }
+
+public:
+    /// Every coordinate is scaled into [`min`, `max`), digits are permuted randomly with `seed` if `scrambled`
+    [[maybe_unused]] explicit Halton(int dimensions, value_type min=0, value_type max=1,
+                                     bool scrambled=true, unsigned int seed=0):
+            dimensions(dimensions), min(min), scale(max - min) {
+        assert(dimensions > 0 and min <= max);
+        // The first `dimensions` primes
+        for (uint32_t candidate = 2; static_cast<int>(bases.size()) < dimensions; ++ candidate) {
+            bool prime = true;
+            for (const auto &base: bases) {
+                prime = prime and candidate % base != 0;
+            }
+            if (prime) {
+                bases.push_back(candidate);
+            }
+        }
+        std::default_random_engine engine(seed);
+        for (const auto &base: bases) {
+            std::vector<uint32_t> permutation(base);
+            for (uint32_t i = 0; i < base; ++ i) {
+                permutation[i] = i;
+            }
+            if (scrambled) {
+                std::shuffle(permutation.begin() + 1, permutation.end(), engine);
+            }
+            permutations.push_back(std::move(permutation));
+        }
+        point.resize(dimensions);
+    }
+
+    /// Generate the next point (the first point is the origin)
+    [[maybe_unused]] const std::vector<value_type> &operator ()() {
+        for (int j = 0; j < dimensions; ++ j) {
+            point[j] = min + scale * static_cast<value_type>(radical_inverse(j, count));
+        }
+        ++ count;
+        return point;
+    }
+
+    /// Fill `points` points into a contiguous buffer (row-major, `points * dimensions` values)
+    [[maybe_unused]] void fill(value_type *buffer, size_t points) {
+        for (size_t i = 0; i < points; ++ i) {
+            const auto &next = (*this)();
+            std::copy(next.begin(), next.end(), buffer + i * dimensions);
+        }
+    }
+
+    /// Jump to the point at `index` (O(1))
+    [[maybe_unused]] void skip_to(uint64_t index) {
+        count = index;
+    }
+
+    /// Index of the next point
+    [[maybe_unused]] [[nodiscard]] uint64_t index() const {
+        return count;
+    }
+};
+
+} // namespace cherry
@@ -0,0 +1,72 @@
+/*
+ * Cherry: memory-mapped files
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cherry {
+
+/// A read-only memory-mapped file
+class [[maybe_unused]] MappedFile {
+private:
+    const char *pointer = nullptr;
+    size_t length = 0;
+
+public:
+    /// Map the whole file, the mapping is empty if failed
+    [[maybe_unused]] explicit MappedFile(const std::string &path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::fprintf(stderr, "Failed to open file %s\n", path.c_str());
+            return;
+        }
+        struct stat status = {};
+        if (fstat(fd, &status) == 0 and status.st_size > 0) {
+            void *address = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED) {
+                pointer = static_cast<const char*>(address);
+                length = status.st_size;
+                madvise(address, length, MADV_SEQUENTIAL);
+            } else {
+                std::fprintf(stderr, "Failed to map file %s\n", path.c_str());
+            }
+        }
+        close(fd);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator =(const MappedFile &) = delete;
+
+    [[maybe_unused]] ~MappedFile() {
+        if (pointer != nullptr) {
+            munmap(const_cast<char*>(pointer), length);
+        }
+    }
+
+    [[maybe_unused]] [[nodiscard]] const char *data() const {
+        return pointer;
+    }
+
+    [[maybe_unused]] [[nodiscard]] size_t size() const {
+        return length;
+    }
+
+    [[maybe_unused]] [[nodiscard]] const char *begin() const {
+        return pointer;
+    }
+
+    [[maybe_unused]] [[nodiscard]] const char *end() const {
+        return pointer + length;
+    }
+};
+
+} // namespace cherry
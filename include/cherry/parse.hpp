@@ -0,0 +1,420 @@
+/*
+ * Cherry: number parsing and string splitting
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "algorithms.hpp"
+#include "mapped_file.hpp"
+
+namespace cherry {
+
+/// Whether a character separates numbers (whitespaces, commas and semicolons)
+[[maybe_unused]] [[nodiscard]] static inline bool is_number_delimiter(char c) {
+    return c == ' ' or c == ',' or c == '\n' or c == '\t' or c == '\r' or c == ';';
+}
+
+/// Skip the delimiters from `begin`, return the first other byte or `end` (long runs, e.g. the padding of aligned
+/// columns, are compared 16 bytes at once, a single delimiter is checked without loading a block)
+[[maybe_unused]] [[nodiscard]] static inline const char *skip_number_delimiters(const char *begin, const char *end) {
+    if (begin == end or not is_number_delimiter(*begin)) {
+        return begin;
+    }
+    if (++ begin == end or not is_number_delimiter(*begin)) {
+        return begin;
+    }
+#if defined(__SSE2__)
+    for (; end - begin >= 16; begin += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i matched = _mm_setzero_si128();
+        for (char delimiter: {' ', ',', '\n', '\t', '\r', ';'}) {
+            matched = _mm_or_si128(matched, _mm_cmpeq_epi8(block, _mm_set1_epi8(delimiter)));
+        }
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matched)) ^ 0xffffu;
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+#endif
+    while (begin != end and is_number_delimiter(*begin)) {
+        ++ begin;
+    }
+    return begin;
+}
+
+/// Parse delimiter-separated numbers in [`begin`, `end`) into a container with `push_back`, return where parsing stopped
+/// (`end` if all the text is parsed, otherwise the first invalid token)
+template <typename T, typename Container>
+[[maybe_unused]] const char *parse_numbers(const char *begin, const char *end, Container &container) {
+    static_assert(std::is_arithmetic<T>::value, "Only arithmetic types can be parsed");
+    while (true) {
+        begin = skip_number_delimiters(begin, end);
+        if (begin == end) {
+            return end;
+        }
+        // `std::from_chars` does not accept a leading plus sign (nor should a sign follow it)
+        const char *first = *begin == '+' ? begin + 1 : begin;
+        if (first != begin and first != end and *first == '-') {
+            return begin;
+        }
+        T value;
+        auto [ptr, error] = std::from_chars(first, end, value);
+        if (error != std::errc() or (ptr != end and not is_number_delimiter(*ptr))) {
+            return begin;
+        }
+        container.push_back(value);
+        begin = ptr;
+    }
+}
+
+/// Parse delimiter-separated numbers in a text into a `std::vector`, return whether all the text is parsed
+template <typename T>
+[[maybe_unused]] bool parse_numbers(const std::string &text, std::vector<T> &vec) {
+    return parse_numbers<T>(text.data(), text.data() + text.size(), vec) == text.data() + text.size();
+}
+
+/// Parse lines of `columns.size()` delimiter-separated numbers into columns (structure of arrays), blank lines are
+/// skipped, return where parsing stopped (the invalid token, or the beginning of a line with another number of values)
+template <typename T>
+[[maybe_unused]] const char *parse_columns(const char *begin, const char *end, std::vector<std::vector<T>> &columns) {
+    assert(not columns.empty());
+    std::vector<T> row;
+    row.reserve(columns.size());
+    while (begin != end) {
+        auto line_end = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+        line_end = line_end == nullptr ? end : line_end;
+        row.clear();
+        const char *stop = parse_numbers<T>(begin, line_end, row);
+        if (stop != line_end) {
+            return stop;
+        }
+        if (not row.empty() and row.size() != columns.size()) {
+            return begin;
+        }
+        for (size_t i = 0; i < row.size(); ++ i) {
+            columns[i].push_back(row[i]);
+        }
+        begin = line_end == end ? end : line_end + 1;
+    }
+    return end;
+}
+
+/// Parse delimiter-separated numbers with threads (the text is split on line boundaries), return whether all parsed
+/// (if not, `vec` gets the numbers before the first invalid token, like `parse_numbers`)
+template <typename T>
+[[maybe_unused]] bool parse_numbers_parallel(const char *begin, const char *end, std::vector<T> &vec,
+                                             int threads=static_cast<int>(std::thread::hardware_concurrency())) {
+    threads = std::max(1, std::min<int>(threads, static_cast<int>((end - begin) / 65536) + 1));
+
+    // Split on line boundaries (`memchr` is vectorized by the C library)
+    std::vector<const char*> splits = {begin};
+    for (int i = 1; i < threads; ++ i) {
+        const char *guess = std::max(begin + (end - begin) * i / threads, splits.back());
+        auto line_end = static_cast<const char*>(std::memchr(guess, '\n', end - guess));
+        splits.push_back(line_end == nullptr ? end : line_end + 1);
+    }
+    splits.push_back(end);
+
+    std::vector<std::vector<T>> parts(threads);
+    std::vector<char> succeeded(threads, false);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++ i) {
+        workers.emplace_back([&, i]() {
+            parts[i].reserve((splits[i + 1] - splits[i]) / 8);
+            succeeded[i] = parse_numbers<T>(splits[i], splits[i + 1], parts[i]) == splits[i + 1];
+        });
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+
+    // Parts after the first failed one are dropped
+    int count = 0;
+    size_t total = vec.size();
+    while (count < threads) {
+        total += parts[count].size();
+        if (not succeeded[count ++]) {
+            break;
+        }
+    }
+    vec.reserve(total);
+    for (int i = 0; i < count; ++ i) {
+        vec.insert(vec.end(), parts[i].begin(), parts[i].end());
+    }
+    return succeeded[count - 1];
+}
+
+/// Find the first byte in [`begin`, `end`) which is one of `delimiters`, return `end` if not found
+[[maybe_unused]] [[nodiscard]] static inline const char *find_delimiter(const char *begin, const char *end,
+                                                                       std::string_view delimiters) {
+    if (delimiters.size() == 1) {
+        auto found = static_cast<const char*>(std::memchr(begin, delimiters[0], end - begin));
+        return found == nullptr ? end : found;
+    }
+#if defined(__AVX2__)
+    for (; end - begin >= 32; begin += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i matched = _mm256_setzero_si256();
+        for (char delimiter: delimiters) {
+            matched = _mm256_or_si256(matched, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(delimiter)));
+        }
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(matched));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    for (; end - begin >= 16; begin += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i matched = _mm_setzero_si128();
+        for (char delimiter: delimiters) {
+            matched = _mm_or_si128(matched, _mm_cmpeq_epi8(block, _mm_set1_epi8(delimiter)));
+        }
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matched));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; begin != end; ++ begin) {
+        if (delimiters.find(*begin) != std::string_view::npos) {
+            return begin;
+        }
+    }
+    return end;
+}
+
+/// Find the last byte in [`begin`, `end`) which is one of `delimiters`, return `end` if not found
+[[maybe_unused]] [[nodiscard]] static inline const char *find_last_delimiter(const char *begin, const char *end,
+                                                                            std::string_view delimiters) {
+    const char *last = end;
+#if defined(__AVX2__)
+    for (; last - begin >= 32; last -= 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(last - 32));
+        __m256i matched = _mm256_setzero_si256();
+        for (char delimiter: delimiters) {
+            matched = _mm256_or_si256(matched, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(delimiter)));
+        }
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(matched));
+        if (mask != 0) {
+            return last - 1 - __builtin_clz(mask);
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    for (; last - begin >= 16; last -= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(last - 16));
+        __m128i matched = _mm_setzero_si128();
+        for (char delimiter: delimiters) {
+            matched = _mm_or_si128(matched, _mm_cmpeq_epi8(block, _mm_set1_epi8(delimiter)));
+        }
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matched));
+        if (mask != 0) {
+            return last - 1 - (__builtin_clz(mask) - 16);
+        }
+    }
+#endif
+    while (last != begin) {
+        if (delimiters.find(*(-- last)) != std::string_view::npos) {
+            return last;
+        }
+    }
+    return end;
+}
+
+/// A lazy range of `std::string_view` tokens split by any of the delimiters (no allocation)
+class [[maybe_unused]] SplitRange {
+private:
+    std::string_view text, delimiters;
+    bool skip_empty, line_mode;
+
+public:
+    [[maybe_unused]] typedef std::string_view value_type;
+
+    /// The iterator type for `SplitRange`
+    struct [[maybe_unused]] Iterator {
+        const SplitRange *range;
+        const char *token_end;
+        std::string_view token;
+        bool done;
+
+        [[maybe_unused]] Iterator(const SplitRange *range, bool done): range(range), token_end(nullptr), done(done) {
+            if (not done) {
+                advance(range->text.data());
+            }
+        }
+
+        /// Locate the token starting at `token_begin`
+        void advance(const char *token_begin) {
+            const char *text_end = range->text.data() + range->text.size();
+            while (true) {
+                if (token_begin == text_end and (range->line_mode or range->skip_empty)) {
+                    done = true;
+                    return;
+                }
+                token_end = find_delimiter(token_begin, text_end, range->delimiters);
+                token = std::string_view(token_begin, token_end - token_begin);
+                if (range->line_mode and not token.empty() and token.back() == '\r') {
+                    token.remove_suffix(1);
+                }
+                if (not range->skip_empty or not token.empty() or token_end == text_end) {
+                    break;
+                }
+                token_begin = token_end + 1;
+            }
+            if (range->skip_empty and token.empty()) {
+                done = true;
+            }
+        }
+
+        [[maybe_unused]] const std::string_view &operator *() const {
+            return token;
+        }
+
+        [[maybe_unused]] const std::string_view *operator ->() const {
+            return &token;
+        }
+
+        [[maybe_unused]] Iterator operator ++() {
+            if (token_end == range->text.data() + range->text.size()) {
+                done = true;
+            } else {
+                advance(token_end + 1);
+            }
+            return *this;
+        }
+
+        [[maybe_unused]] bool operator ==(const Iterator &other) const {
+            return done == other.done and (done or token.data() == other.token.data());
+        }
+
+        [[maybe_unused]] bool operator !=(const Iterator &other) const {
+            return not (*this == other);
+        }
+    };
+
+    /// The reverse iterator type for `SplitRange` (the same tokens from the last, delimiters are found backwards)
+    struct [[maybe_unused]] ReverseIterator {
+        const SplitRange *range;
+        const char *token_begin;
+        std::string_view token;
+        bool done;
+
+        [[maybe_unused]] ReverseIterator(const SplitRange *range, bool done):
+                range(range), token_begin(nullptr), done(done) {
+            if (done) {
+                return;
+            }
+            const char *text_end = range->text.data() + range->text.size();
+            if (range->line_mode and not range->text.empty() and range->text.back() == '\n') {
+                // No empty line after the last line break
+                -- text_end;
+            }
+            this->done = range->line_mode and range->text.empty();
+            if (not this->done) {
+                retreat(text_end);
+            }
+        }
+
+        /// Locate the token ending at `token_end`
+        void retreat(const char *token_end) {
+            const char *text_begin = range->text.data();
+            while (true) {
+                const char *delimiter = find_last_delimiter(text_begin, token_end, range->delimiters);
+                token_begin = delimiter == token_end ? text_begin : delimiter + 1;
+                token = std::string_view(token_begin, token_end - token_begin);
+                if (range->line_mode and not token.empty() and token.back() == '\r') {
+                    token.remove_suffix(1);
+                }
+                if (not range->skip_empty or not token.empty()) {
+                    return;
+                }
+                if (token_begin == text_begin) {
+                    done = true;
+                    return;
+                }
+                token_end = token_begin - 1;
+            }
+        }
+
+        [[maybe_unused]] const std::string_view &operator *() const {
+            return token;
+        }
+
+        [[maybe_unused]] const std::string_view *operator ->() const {
+            return &token;
+        }
+
+        [[maybe_unused]] ReverseIterator operator ++() {
+            if (token_begin == range->text.data()) {
+                done = true;
+            } else {
+                retreat(token_begin - 1);
+            }
+            return *this;
+        }
+
+        [[maybe_unused]] bool operator ==(const ReverseIterator &other) const {
+            return done == other.done and (done or token.data() == other.token.data());
+        }
+
+        [[maybe_unused]] bool operator !=(const ReverseIterator &other) const {
+            return not (*this == other);
+        }
+    };
+
+    typedef Iterator iterator;
+    typedef Iterator const_iterator;
+    typedef ReverseIterator reverse_iterator;
+    typedef ReverseIterator const_reverse_iterator;
+
+    [[maybe_unused]] SplitRange(std::string_view text, std::string_view delimiters, bool skip_empty, bool line_mode):
+            text(text), delimiters(delimiters), skip_empty(skip_empty), line_mode(line_mode) {
+        assert(not delimiters.empty());
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator begin() const {
+        return const_iterator(this, false);
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator end() const {
+        return const_iterator(this, true);
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(this, false);
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_reverse_iterator rend() const {
+        return const_reverse_iterator(this, true);
+    }
+};
+
+/// Return a lazy range of tokens split by any of `delimiters` (empty tokens are kept unless `skip_empty`)
+[[maybe_unused]] [[nodiscard]] static inline SplitRange split(std::string_view text, std::string_view delimiters,
+                                                              bool skip_empty=false) {
+    return SplitRange(text, delimiters, skip_empty, false);
+}
+
+/// Return a lazy range of lines (without `\n` or `\r\n`, no empty line after the last line break)
+[[maybe_unused]] [[nodiscard]] static inline SplitRange lines(std::string_view text) {
+    return SplitRange(text, "\n", false, true);
+}
+
+} // namespace cherry
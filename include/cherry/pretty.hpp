@@ -0,0 +1,175 @@
+/*
+ * Cherry: pretty printing
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "sink.hpp"
+
+namespace cherry {
+
+/// Convert a number to `std::string` with units
+template <typename T>
+[[maybe_unused]] [[nodiscard]] std::string pretty(T value, T scale, const char* *units, int max_level) {
+    int count = 0;
+    auto d = std::abs(static_cast<double>(value));
+    while (d > scale && count < max_level - 1) {
+        d /= scale;
+        count += 1;
+    }
+    static char buffer[64];
+    sprintf(buffer, "%s%.3f %s", value < 0 ? "-" : "", d, units[count]);
+    return buffer;
+}
+
+/// Convert a size to `std::string` with units
+[[maybe_unused]] [[nodiscard]] static std::string pretty_bytes(size_t size) {
+    static const char* units[5] = {"B", "KiB", "MiB", "GiB"};
+    return pretty<size_t>(size, 1024, units, 4);
+}
+
+/// Convert a size to `std::string` with units
+[[maybe_unused]] [[nodiscard]] static std::string pretty_bytes(long long size) {
+    static const char* units[5] = {"B", "KiB", "MiB", "GiB"};
+    return pretty<long long>(size, 1024, units, 4);
+}
+
+/// Variance between two variables
+template <typename T>
+[[maybe_unused]] [[nodiscard]] static std::string pretty_variance(T before, T after) {
+    auto before_d = static_cast<double>(before);
+    auto after_d = static_cast<double>(after);
+    static char buffer[256];
+    sprintf(buffer, "%.2lf%%", (after_d - before_d) / (before_d) * 100);
+    return (after_d >= before_d ? "+" : "") + std::string(buffer);
+}
+
+/// Convert a nanosecond to `std::string` with units (always millisecond if `fixed` is true)
+[[maybe_unused]] [[nodiscard]] static std::string pretty_nanoseconds(uint64_t duration, bool fixed= true) {
+    // To millisecond
+    if (fixed) {
+        static char buffer[64];
+        sprintf(buffer, "%.3f ms", static_cast<double>(duration) / 1e6);
+        return buffer;
+    }
+    // Non-fixed
+    static const char* units[5] = {"ns", "us", "ms", "s"};
+    return pretty<uint64_t>(duration, 1000, units, 4);
+}
+
+/// A value for `Sink` (numbers, pointers and strings as they are, other types formatted by `operator <<`)
+template <typename T>
+[[maybe_unused]] [[nodiscard]] decltype(auto) sink_value(const T &value) {
+    if constexpr (is_sink_formattable<T>::value) {
+        return (value);
+    } else {
+        std::ostringstream stream;
+        stream << value;
+        return stream.str();
+    }
+}
+
+/// Append a value to `std::string` (numbers by `std::to_chars`, other types by `operator <<`)
+template <typename T>
+[[maybe_unused]] static inline void append_value(std::string &text, const T &value) {
+    if constexpr (std::is_convertible<const T&, std::string_view>::value) {
+        text += std::string_view(value);
+    } else if constexpr (is_sink_formattable<T>::value) {
+        char buffer[max_formatted_length];
+        text.append(buffer, format_value(buffer, value));
+    } else {
+        text += sink_value(value);
+    }
+}
+
+/// Concat a range to `std::string`
+template <typename Range>
+[[maybe_unused]] [[nodiscard]] std::string pretty_range(const Range &range) {
+    std::string text = "[";
+    bool first = true;
+    for (const auto &value: range) {
+        text += first ? "" : ", ";
+        append_value(text, value);
+        first = false;
+    }
+    text += "]";
+    return text;
+}
+
+/// Show progress status
+template <typename FuncType>
+[[maybe_unused]] void pretty_progress(FuncType func, const std::string& info, const std::string& notice="OK!") {
+    auto &sink = Sink::standard_output();
+    std::fflush(stdout);
+    sink.print(info, " ... ");
+    sink.flush();
+    func();
+    sink.print(notice, '\n');
+}
+
+/// Console colors
+class [[maybe_unused]] ConsoleColor {
+public:
+    [[maybe_unused]] static constexpr const char *reset  = "\033[0m";
+    [[maybe_unused]] static constexpr const char *black  = "\033[30m";
+    [[maybe_unused]] static constexpr const char *red    = "\033[31m";
+    [[maybe_unused]] static constexpr const char *green  = "\033[32m";
+    [[maybe_unused]] static constexpr const char *yellow = "\033[33m";
+    [[maybe_unused]] static constexpr const char *blue   = "\033[34m";
+    [[maybe_unused]] static constexpr const char *white  = "\033[37m";
+};
+
+/// Whether `print_args` leaves its output in the sink buffer (faster for many prints, opt-in): then the sink must be
+/// flushed before writing into `std::cout` or `stdout` again
+inline std::atomic<bool> buffered_print_args{false};
+
+/// Print args separated by spaces into `Sink::standard_output()` (at least one, nothing is formatted if disabled),
+/// ordered with `std::cout` and `stdout`: they are flushed first, and the sink after unless `buffered_print_args`
+template <typename Arg, typename... Args>
+[[maybe_unused]] void print_args(Arg arg, Args... args) {
+    auto &sink = Sink::standard_output();
+    if (sink.is_enabled()) {
+        std::fflush(stdout);
+        sink.print_separated(" ", sink_value(arg), sink_value(args)...);
+        if (not buffered_print_args.load(std::memory_order_relaxed)) {
+            sink.flush();
+        }
+    }
+}
+
+/// Debug print (file and line), ordered like `print_args` and always flushed by lines (not lost on crashes)
+template <typename... Args>
+[[maybe_unused]] void debug_print_impl(int line, const char *path, Args... args) {
+    auto &sink = Sink::standard_output();
+    if (not sink.is_enabled()) {
+        return;
+    }
+    std::fflush(stdout);
+    sink.print(ConsoleColor::green, "[♫ Debug#", line, "@", path, "] ", ConsoleColor::reset);
+    if constexpr (sizeof...(Args) > 0) {
+        sink.print_separated(" ", sink_value(args)...);
+    } else {
+        sink.print("๑¯◡¯๑");
+    }
+    sink.print('\n');
+    sink.flush();
+}
+
+/// Debug print (file and line, macro)
+#define debug_print(...) cherry::debug_print_impl(__LINE__, __FILE__, ##__VA_ARGS__)
+
+/// Convert a rate (per second) to `std::string` with units
+[[maybe_unused]] [[nodiscard]] static std::string pretty_rate(double rate) {
+    static const char* units[5] = {"/s", "K/s", "M/s", "G/s"};
+    return pretty<double>(rate, 1000, units, 4);
+}
+
+} // namespace cherry
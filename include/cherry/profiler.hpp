@@ -0,0 +1,204 @@
+/*
+ * Cherry: sampling profiler
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <map>
+#include <string>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "ranges.hpp"
+
+namespace cherry {
+
+/// An opt-in in-process sampling profiler driven by `SIGPROF`, producing folded stacks for flame graphs
+class [[maybe_unused]] SamplingProfiler {
+public:
+    /// Max frames captured per sample
+    static constexpr int max_depth = 64;
+
+private:
+    // The frames of the signal handler and the signal trampoline
+    static constexpr int skipped_frames = 2;
+
+    struct Sample {
+        std::atomic<int> depth{0};
+        void *frames[max_depth];
+    };
+
+    static inline Sample *samples = nullptr;
+    static inline size_t capacity = 0;
+    static inline std::atomic<size_t> count{0}, dropped{0};
+    static inline std::atomic<bool> running{false};
+    static inline int64_t interval_ns = 0;
+    // Whether the current thread is sampled by its own timer (and skips the process-wide one)
+    static inline thread_local bool own_timer = false;
+
+    static void signal_handler(int, siginfo_t *info, void *) {
+        if (not running.load(std::memory_order_relaxed) or (own_timer and info->si_code != SI_TIMER)) {
+            return;
+        }
+        int saved_errno = errno;
+        size_t index = count.fetch_add(1, std::memory_order_relaxed);
+        if (index < capacity) {
+            Sample &sample = samples[index];
+            int depth = backtrace(sample.frames, max_depth);
+            sample.depth.store(depth, std::memory_order_release);
+        } else {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        errno = saved_errno;
+    }
+
+    /// Symbolize an address into a function name (or `module+offset`)
+    [[nodiscard]] static std::string symbolize(void *address) {
+        Dl_info info;
+        if (dladdr(address, &info) == 0) {
+            char buffer[32];
+            sprintf(buffer, "%p", address);
+            return buffer;
+        }
+        if (info.dli_sname != nullptr) {
+            int status = 0;
+            char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            std::string name = status == 0 ? demangled : info.dli_sname;
+            std::free(demangled);
+            return name;
+        }
+        const char *module = info.dli_fname == nullptr ? "?" : info.dli_fname;
+        if (const char *slash = std::strrchr(module, '/')) {
+            module = slash + 1;
+        }
+        char buffer[32];
+        sprintf(buffer, "+0x%lx", static_cast<unsigned long>(
+                reinterpret_cast<uintptr_t>(address) - reinterpret_cast<uintptr_t>(info.dli_fbase)));
+        return module + std::string(buffer);
+    }
+
+public:
+    /// Start sampling the whole process at `frequency` Hz of CPU time, with a preallocated buffer of `max_samples`,
+    /// return whether the timer is armed
+    [[maybe_unused]] static bool start(int frequency=99, size_t max_samples=65536) {
+        assert(not running.load() and frequency > 0);
+        // `backtrace` may allocate on the first call, warm it up out of the signal handler
+        void *warm_up[1];
+        backtrace(warm_up, 1);
+
+        delete[] samples;
+        samples = new Sample[max_samples];
+        capacity = max_samples;
+        count = 0, dropped = 0;
+        interval_ns = std::max<int64_t>(1000, 1000000000 / frequency);
+
+        struct sigaction action = {};
+        action.sa_sigaction = signal_handler;
+        action.sa_flags = SA_RESTART | SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGPROF, &action, nullptr);
+        running = true;
+
+        // The interval may be a whole second (`tv_usec` must stay below one)
+        struct itimerval timer = {};
+        timer.it_interval.tv_sec = static_cast<time_t>(interval_ns / 1000000000);
+        timer.it_interval.tv_usec = static_cast<suseconds_t>(interval_ns % 1000000000 / 1000);
+        timer.it_value = timer.it_interval;
+        if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+            running = false;
+            return false;
+        }
+        return true;
+    }
+
+    /// Sample the current thread by its own CPU time (`timer_create`) instead of the process-wide timer,
+    /// return whether succeeded and the timer to `stop_thread` (a null `timer_t` is a valid timer)
+    [[maybe_unused]] static bool profile_this_thread(timer_t &timer) {
+        assert(running.load());
+        struct sigevent event = {};
+        event.sigev_notify = SIGEV_THREAD_ID;
+        event.sigev_signo = SIGPROF;
+        event._sigev_un._tid = static_cast<pid_t>(syscall(SYS_gettid));
+        if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer) != 0) {
+            return false;
+        }
+        struct itimerspec spec = {};
+        spec.it_interval.tv_sec = static_cast<time_t>(interval_ns / 1000000000);
+        spec.it_interval.tv_nsec = static_cast<long>(interval_ns % 1000000000);
+        spec.it_value = spec.it_interval;
+        if (timer_settime(timer, 0, &spec, nullptr) != 0) {
+            timer_delete(timer);
+            return false;
+        }
+        own_timer = true;
+        return true;
+    }
+
+    /// Stop a per-thread timer created by `profile_this_thread` (in the same thread)
+    [[maybe_unused]] static void stop_thread(timer_t timer) {
+        timer_delete(timer);
+        own_timer = false;
+    }
+
+    /// Stop sampling (the handler stays installed but ignores late signals)
+    [[maybe_unused]] static void stop() {
+        struct itimerval timer = {};
+        setitimer(ITIMER_PROF, &timer, nullptr);
+        running = false;
+    }
+
+    /// Number of samples captured
+    [[maybe_unused]] [[nodiscard]] static size_t samples_count() {
+        return std::min(count.load(), capacity);
+    }
+
+    /// Number of samples dropped because the buffer is full
+    [[maybe_unused]] [[nodiscard]] static size_t dropped_count() {
+        return dropped.load();
+    }
+
+    /// Aggregate and symbolize the samples into the folded-stack format (`outer;...;inner count` per line)
+    [[maybe_unused]] [[nodiscard]] static std::string folded() {
+        assert(not running.load());
+        std::map<std::vector<void*>, size_t> stacks;
+        for (size_t i = 0; i < samples_count(); ++ i) {
+            int depth = samples[i].depth.load(std::memory_order_acquire);
+            if (depth <= skipped_frames) {
+                continue;
+            }
+            std::vector<void*> stack(samples[i].frames + skipped_frames, samples[i].frames + depth);
+            ++ stacks[stack];
+        }
+        std::map<void*, std::string> names;
+        std::map<std::string, size_t> lines;
+        for (const auto &[stack, times]: stacks) {
+            std::string line;
+            for (const auto &address: reverse(stack)) {
+                if (not names.count(address)) {
+                    names[address] = symbolize(address);
+                }
+                line += (line.empty() ? "" : ";") + names[address];
+            }
+            lines[line] += times;
+        }
+        std::string text;
+        for (const auto &[line, times]: lines) {
+            text += line + " " + std::to_string(times) + "\n";
+        }
+        return text;
+    }
+};
+
+} // namespace cherry
@@ -0,0 +1,181 @@
+/*
+ * Cherry: random number generators and heavy-tailed samplers
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+
+namespace cherry {
+
+/// A random number generator
+template <typename value_type>
+class [[maybe_unused]] Random {
+private:
+    // `std::uniform_int_distribution<bool>` is not allowed by the standard, so generate `int` for `bool`
+    typedef typename std::conditional<std::is_same<value_type, bool>::value, int, value_type>::type dist_value_t;
+    typedef typename std::conditional<std::is_integral<value_type>::value,
+            std::uniform_int_distribution<dist_value_t>, std::uniform_real_distribution<dist_value_t>>::type dist_t;
+
+    std::default_random_engine engine;
+    dist_t dist;
+
+public:
+    /// The interval is closed ([`min`, `max`])
+    [[maybe_unused]] Random(value_type min, value_type max, bool pure=true, unsigned int seed=0) { // NOLINT(cert-msc51-cpp)
+        assert(min <= max);
+        if (pure) {
+            seed = std::random_device()();
+        }
+        engine = std::default_random_engine(seed);
+        dist = dist_t(min, max);
+    }
+
+    /// Generate a random number
+    [[maybe_unused]] value_type operator ()() {
+        return static_cast<value_type>(dist(engine));
+    }
+};
+
+/// A Zipf(`n`, `exponent`) sampler of ranks in [1, `n`], by rejection-inversion (O(1) expected time and O(1) memory)
+template <typename value_type=uint64_t>
+class [[maybe_unused]] Zipf {
+private:
+    static_assert(std::is_integral<value_type>::value, "Zipf ranks must be integral");
+
+    std::default_random_engine engine;
+    std::uniform_real_distribution<double> uniform;
+    double n, exponent;
+    double h_integral_x1, h_integral_n, threshold;
+
+    /// log(1 + x) / x, stable near 0
+    [[nodiscard]] static double helper1(double x) {
+        return std::abs(x) > 1e-8 ? std::log1p(x) / x : 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+    }
+
+    /// (exp(x) - 1) / x, stable near 0
+    [[nodiscard]] static double helper2(double x) {
+        return std::abs(x) > 1e-8 ? std::expm1(x) / x : 1 + x * 0.5 * (1 + x / 3 * (1 + 0.25 * x));
+    }
+
+    /// The hat function h(x) = 1 / x^exponent
+    [[nodiscard]] double h(double x) const {
+        return std::exp(-exponent * std::log(x));
+    }
+
+    /// The integral of h from 1 to x (shifted)
+    [[nodiscard]] double h_integral(double x) const {
+        double log_x = std::log(x);
+        return helper2((1 - exponent) * log_x) * log_x;
+    }
+
+    [[nodiscard]] double h_integral_inverse(double x) const {
+        double t = std::max(-1.0, x * (1 - exponent));
+        return std::exp(helper1(t) * x);
+    }
+
+public:
+    /// `exponent` must be positive
+    [[maybe_unused]] Zipf(uint64_t n, double exponent, bool pure=true, unsigned int seed=0): // NOLINT(cert-msc51-cpp)
+            uniform(0, 1), n(static_cast<double>(n)), exponent(exponent) {
+        assert(n > 0 and exponent > 0);
+        if (pure) {
+            seed = std::random_device()();
+        }
+        engine = std::default_random_engine(seed);
+        h_integral_x1 = h_integral(1.5) - 1;
+        h_integral_n = h_integral(this->n + 0.5);
+        threshold = 2 - h_integral_inverse(h_integral(2.5) - h(2));
+    }
+
+    /// Generate a rank
+    [[maybe_unused]] value_type operator ()() {
+        while (true) {
+            double u = h_integral_n + uniform(engine) * (h_integral_x1 - h_integral_n);
+            double x = h_integral_inverse(u);
+            double k = std::min(std::max(std::floor(x + 0.5), 1.0), n);
+            if (k - x <= threshold or u >= h_integral(k + 0.5) - h(k)) {
+                return static_cast<value_type>(k);
+            }
+        }
+    }
+
+    /// Generate `count` ranks into a contiguous buffer
+    [[maybe_unused]] void fill(value_type *buffer, size_t count) {
+        for (size_t i = 0; i < count; ++ i) {
+            buffer[i] = (*this)();
+        }
+    }
+};
+
+/// A Pareto sampler with `scale` (minimum value) and `shape` (tail index), by inversion
+template <typename value_type=double>
+class [[maybe_unused]] Pareto {
+private:
+    static_assert(std::is_floating_point<value_type>::value, "Pareto values must be floating-point");
+
+    std::default_random_engine engine;
+    std::uniform_real_distribution<double> uniform;
+    double scale, inverse_shape;
+
+public:
+    [[maybe_unused]] Pareto(value_type scale, value_type shape, bool pure=true, unsigned int seed=0): // NOLINT(cert-msc51-cpp)
+            uniform(0, 1), scale(scale), inverse_shape(1 / static_cast<double>(shape)) {
+        assert(scale > 0 and shape > 0);
+        if (pure) {
+            seed = std::random_device()();
+        }
+        engine = std::default_random_engine(seed);
+    }
+
+    /// Generate a value in [`scale`, +inf)
+    [[maybe_unused]] value_type operator ()() {
+        // 1 - U is in (0, 1]
+        return static_cast<value_type>(scale / std::pow(1 - uniform(engine), inverse_shape));
+    }
+
+    /// Generate `count` values into a contiguous buffer
+    [[maybe_unused]] void fill(value_type *buffer, size_t count) {
+        for (size_t i = 0; i < count; ++ i) {
+            buffer[i] = (*this)();
+        }
+    }
+};
+
+/// A log-normal sampler, `mu` and `sigma` are of the underlying normal distribution
+template <typename value_type=double>
+class [[maybe_unused]] LogNormal {
+private:
+    static_assert(std::is_floating_point<value_type>::value, "Log-normal values must be floating-point");
+
+    std::default_random_engine engine;
+    std::lognormal_distribution<value_type> dist;
+
+public:
+    [[maybe_unused]] LogNormal(value_type mu, value_type sigma, bool pure=true, unsigned int seed=0): // NOLINT(cert-msc51-cpp)
+            dist(mu, sigma) {
+        assert(sigma > 0);
+        if (pure) {
+            seed = std::random_device()();
+        }
+        engine = std::default_random_engine(seed);
+    }
+
+    /// Generate a value
+    [[maybe_unused]] value_type operator ()() {
+        return dist(engine);
+    }
+
+    /// Generate `count` values into a contiguous buffer
+    [[maybe_unused]] void fill(value_type *buffer, size_t count) {
+        for (size_t i = 0; i < count; ++ i) {
+            buffer[i] = dist(engine);
+        }
+    }
+};
+
+} // namespace cherry
@@ -0,0 +1,771 @@
+/*
+ * Cherry: range views (shift, reverse, indexing, join, iota and product)
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+
+namespace cherry {
+
+// TODO: Support enumerate with index
+// NOTE: The compiler error may not be friendly when use `iterator` as `const_iterator` by force
+
+/// A shifted range wrapper
+template <typename Range>
+class [[maybe_unused]] ShiftRange {
+private:
+    int pos, length = -1;
+    Range &range;
+
+public:
+    typedef typename std::conditional<std::is_const<Range>::value,
+            typename Range::const_iterator, typename Range::iterator>::type iterator;
+    typedef typename std::conditional<std::is_const<Range>::value,
+            typename Range::const_reverse_iterator, typename Range::reverse_iterator>::type reverse_iterator;
+    typedef typename Range::const_iterator const_iterator;
+    typedef typename Range::const_reverse_iterator const_reverse_iterator;
+    [[maybe_unused]] typedef typename Range::value_type value_type;
+
+    constexpr explicit ShiftRange(Range &range, int pos=0, int length=-1): range(range), pos(pos) {
+        this->length = length == -1 ? range.end() - range.begin() - pos : length;
+        assert(pos + this->length <= range.end() - range.begin());
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr iterator begin() {
+        return range.begin() + pos;
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr iterator end() {
+        return range.begin() + pos + length;
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr reverse_iterator rbegin() {
+        auto cut = range.end() - range.begin() - (pos + length);
+        return range.rbegin() + cut;
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr reverse_iterator rend() {
+        auto cut = range.end() - range.begin() - pos;
+        return range.rbegin() + cut;
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_iterator begin() const {
+        return range.begin() + pos;
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_iterator end() const {
+        return range.begin() + pos + length;
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_reverse_iterator rbegin() const {
+        auto cut = range.end() - range.begin() - (pos + length);
+        return range.rbegin() + cut;
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_reverse_iterator rend() const {
+        auto cut = range.end() - range.begin() - pos;
+        return range.rbegin() + cut;
+    }
+};
+
+/// Return a shifted range wrapper (uses left-value reference)
+template <typename Range>
+[[maybe_unused]] [[nodiscard]] constexpr ShiftRange<Range> shift(Range &range, int pos=0, int length=-1) {
+    return ShiftRange(range, pos, length);
+}
+
+/// Return a shifted range wrapper (uses const reference)
+template <typename Range>
+[[maybe_unused]] [[nodiscard]] constexpr const ShiftRange<const Range> shift(const Range &range, int pos=0, int length=-1) {
+    return ShiftRange<const Range>(range, pos, length);
+}
+
+/// A reversed range wrapper
+template <typename Range>
+class [[maybe_unused]] ReversedRange {
+private:
+    Range &range;
+
+public:
+    typedef typename std::conditional<std::is_const<Range>::value, typename Range::const_reverse_iterator, typename Range::reverse_iterator>::type iterator;
+    typedef typename std::conditional<std::is_const<Range>::value, typename Range::const_iterator, typename Range::iterator>::type reverse_iterator;
+    typedef typename Range::const_reverse_iterator const_iterator;
+    typedef typename Range::const_iterator const_reverse_iterator;
+    [[maybe_unused]] typedef typename Range::value_type value_type;
+
+    constexpr explicit ReversedRange(Range &range): range(range) {}
+
+    [[maybe_unused]] [[nodiscard]] constexpr iterator begin() {
+        return range.rbegin();
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr iterator end() {
+        return range.rend();
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr reverse_iterator rbegin() {
+        return range.begin();
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr reverse_iterator rend() {
+        return range.end();
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_iterator begin() const {
+        return range.rbegin();
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_iterator end() const {
+        return range.rend();
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_reverse_iterator rbegin() const {
+        return range.begin();
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_reverse_iterator rend() const {
+        return range.end();
+    }
+};
+
+/// Return a reversed range wrapper (uses left-value reference)
+template <typename Range>
+[[maybe_unused]] [[nodiscard]] constexpr ReversedRange<Range> reverse(Range &range) {
+    return ReversedRange<Range>(range);
+}
+
+/// Return a reversed range wrapper (uses right-value)
+template <typename Range>
+[[maybe_unused]] [[nodiscard]] constexpr ReversedRange<Range> reverse(Range &&range) {
+    return ReversedRange<Range>(range);
+}
+
+/// Return a reversed range wrapper (uses const reference)
+template <typename Range>
+[[maybe_unused]] [[nodiscard]] constexpr const ReversedRange<const Range> reverse(const Range &range) {
+    return ReversedRange<const Range>(range);
+}
+
+/// A range iterated by an indexing array
+template <typename Array, typename Range>
+class [[maybe_unused]] IndexingRange {
+private:
+    Array &items;
+    const Range &indexes;
+
+public:
+    [[maybe_unused]] typedef typename Array::value_type value_type;
+    typedef typename std::conditional<std::is_const<Array>::value,
+            const typename Array::value_type&, typename Array::value_type&>::type reference;
+
+    /// The iterator type for `IndexingRange`
+    template<typename index_const_iterator_t>
+    struct [[maybe_unused]] Iterator {
+        Array &items;
+        index_const_iterator_t index_const_iterator;
+
+        [[maybe_unused]] constexpr Iterator(Array &items, const index_const_iterator_t &index_const_iterator):
+                items(items), index_const_iterator(index_const_iterator) {}
+
+        [[maybe_unused]] constexpr reference operator *() const {
+            return items[*index_const_iterator];
+        }
+
+        [[maybe_unused]] constexpr Iterator operator ++() {
+            index_const_iterator ++;
+            return *this;
+        }
+
+        [[maybe_unused]] constexpr bool operator ==(const Iterator &other) const {
+            return index_const_iterator == other.index_const_iterator;
+        }
+
+        [[maybe_unused]] constexpr bool operator !=(const Iterator &other) const {
+            return index_const_iterator != other.index_const_iterator;
+        }
+    };
+
+    typedef Iterator<typename Range::const_iterator> iterator;
+    typedef Iterator<typename Range::const_reverse_iterator> reverse_iterator;
+    typedef Iterator<typename Range::const_iterator> const_iterator;
+    typedef Iterator<typename Range::const_reverse_iterator> const_reverse_iterator;
+
+    [[maybe_unused]] constexpr IndexingRange(Array &items, const Range &indexes):
+            items(items), indexes(indexes) {}
+
+    [[maybe_unused]] [[nodiscard]] constexpr iterator begin() {
+        return iterator(items, indexes.begin());
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr iterator end() {
+        return iterator(items, indexes.end());
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr reverse_iterator rbegin() {
+        return reverse_iterator(items, indexes.rbegin());
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr reverse_iterator rend() {
+        return reverse_iterator(items, indexes.rend());
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_iterator begin() const {
+        return const_iterator(items, indexes.begin());
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_iterator end() const {
+        return const_iterator(items, indexes.end());
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(items, indexes.rbegin());
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_reverse_iterator rend() const {
+        return const_reverse_iterator(items, indexes.rend());
+    }
+};
+
+/// Return a range iterated by an indexing array (`array` is left-value reference)
+template <typename Array, typename Range>
+[[maybe_unused]] [[nodiscard]] constexpr IndexingRange<Array, Range> indexing(Array &array, const Range &indexes) {
+    return IndexingRange<Array, Range>(array, indexes);
+}
+
+/// Return a range iterated by an indexing array (`array` is const reference)
+template <typename Array, typename Range>
+[[maybe_unused]] [[nodiscard]] constexpr const IndexingRange<const Array, Range> indexing(const Array &array, const Range &indexes) {
+    return IndexingRange<const Array, Range>(array, indexes);
+}
+
+/// A joined range for two ranges
+template <typename Range1, typename Range2>
+class [[maybe_unused]] JoinedRange {
+private:
+    Range1 &range1;
+    Range2 &range2;
+
+public:
+    // Check whether they're the same type
+    static_assert(std::is_same<typename Range1::value_type, typename Range2::value_type>::value,
+    "The types of two ranges in JoinedRange must be same");
+
+    static constexpr bool be_const = std::is_const<Range1>::value or std::is_const<Range2>::value;
+    [[maybe_unused]] typedef typename Range1::value_type value_type;
+    typedef typename std::conditional<be_const,
+            const typename Range1::value_type&, typename Range1::value_type&>::type reference;
+
+    /// The iterator type for `JoinedRange`
+    template <typename iterator1_t, typename iterator2_t>
+    struct [[maybe_unused]] Iterator {
+        bool first;
+        iterator1_t iterator1, iterator1_end;
+        iterator2_t iterator2;
+
+        [[maybe_unused]] constexpr Iterator(bool first, const iterator1_t &iterator1, const iterator1_t &iterator1_end, const iterator2_t &iterator2):
+                first(first), iterator1(iterator1), iterator1_end(iterator1_end), iterator2(iterator2) {}
+
+        [[maybe_unused]] constexpr Iterator(const iterator1_t &iterator1, const iterator1_t &iterator1_end, const iterator2_t &iterator2):
+                first(iterator1 != iterator1_end), iterator1(iterator1), iterator1_end(iterator1_end), iterator2(iterator2) {}
+
+        // Const iterators of a non-const `JoinedRange` must not return `reference`
+        [[maybe_unused]] constexpr decltype(auto) operator *() const {
+            return first ? *iterator1 : *iterator2;
+        }
+
+        [[maybe_unused]] constexpr Iterator operator ++() {
+            if (first) {
+                ++ iterator1;
+                if (iterator1 == iterator1_end) {
+                    first = false;
+                }
+            } else {
+                ++ iterator2;
+            }
+            return *this;
+        }
+
+        [[maybe_unused]] constexpr bool operator ==(const Iterator &other) const {
+            if (first != other.first) {
+                return false;
+            }
+            return first ? iterator1 == other.iterator1 : iterator2 == other.iterator2;
+        }
+
+        [[maybe_unused]] constexpr bool operator !=(const Iterator &other) const {
+            if (first == other.first) {
+                return first ? iterator1 != other.iterator1 : iterator2 != other.iterator2;
+            }
+            return true;
+        }
+    };
+
+    typedef typename std::conditional<be_const,
+            Iterator<typename Range1::const_iterator, typename Range2::const_iterator>,
+            Iterator<typename Range1::iterator, typename Range2::iterator>>::type iterator;
+    typedef typename std::conditional<be_const,
+            Iterator<typename Range1::const_reverse_iterator, typename Range2::const_reverse_iterator>,
+            Iterator<typename Range1::reverse_iterator, typename Range2::reverse_iterator>>::type reverse_iterator;
+    typedef Iterator<typename Range1::const_iterator, typename Range2::const_iterator> const_iterator;
+    typedef Iterator<typename Range2::const_reverse_iterator, typename Range1::const_reverse_iterator> const_reverse_iterator;
+
+    [[maybe_unused]] constexpr JoinedRange(Range1 &range1, Range2 &range2): range1(range1), range2(range2) {}
+
+    [[maybe_unused]] [[nodiscard]] constexpr iterator begin() {
+        return iterator(range1.begin(), range1.end(), range2.begin());
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr iterator end() {
+        return iterator(false, range1.end(), range1.end(), range2.end());
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr reverse_iterator rbegin() {
+        return reverse_iterator(range2.rbegin(), range2.rend(), range1.rbegin());
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr reverse_iterator rend() {
+        return reverse_iterator(false, range2.rend(), range2.rend(), range1.rend());
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_iterator begin() const {
+        return const_iterator(range1.begin(), range1.end(), range2.begin());
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_iterator end() const {
+        return const_iterator(false, range1.end(), range1.end(), range2.end());
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(range2.rbegin(), range2.rend(), range1.rbegin());
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_reverse_iterator rend() const {
+        return const_reverse_iterator(false, range2.rend(), range2.rend(), range1.rend());
+    }
+};
+
+/// Return a joined range (1st range: left-value reference, 2nd range: left-value reference)
+template <typename Range1, typename Range2>
+[[maybe_unused]] [[nodiscard]] constexpr JoinedRange<Range1, Range2> join(Range1 &range1, Range2 &range2) {
+    return JoinedRange<Range1, Range2>(range1, range2);
+}
+
+/// Return a joined range (1st range: left-value reference, 2nd range: right-value)
+template <typename Range1, typename Range2>
+[[maybe_unused]] [[nodiscard]] constexpr JoinedRange<Range1, Range2> join(Range1 &range1, Range2 &&range2) {
+    return JoinedRange<Range1, Range2>(range1, range2);
+}
+
+/// Return a joined range (1st range: left-value reference, 2nd range: const reference)
+template <typename Range1, typename Range2>
+[[maybe_unused]] [[nodiscard]] constexpr const JoinedRange<Range1, const Range2> join(Range1 &range1, const Range2 &range2) {
+    return JoinedRange<Range1, const Range2>(range1, range2);
+}
+
+/// Return a joined range (1st range: right-value, 2nd range: left-value reference)
+template <typename Range1, typename Range2>
+[[maybe_unused]] [[nodiscard]] constexpr JoinedRange<Range1, Range2> join(Range1 &&range1, Range2 &range2) {
+    return JoinedRange<Range1, Range2>(range1, range2);
+}
+
+/// Return a joined range (1st range: right-value, 2nd range: right-value)
+template <typename Range1, typename Range2>
+[[maybe_unused]] [[nodiscard]] constexpr JoinedRange<Range1, Range2> join(Range1 &&range1, Range2 &&range2) {
+    return JoinedRange<Range1, Range2>(range1, range2);
+}
+
+/// Return a joined range (1st range: right-value, 2nd range: const reference)
+template <typename Range1, typename Range2>
+[[maybe_unused]] [[nodiscard]] constexpr const JoinedRange<Range1, const Range2> join(Range1 &&range1, const Range2 &range2) {
+    return JoinedRange<Range1, const Range2>(range1, range2);
+}
+
+/// Return a joined range (1st range: const reference, 2nd range: left-value reference)
+template <typename Range1, typename Range2>
+[[maybe_unused]] [[nodiscard]] constexpr const JoinedRange<const Range1, Range2> join(const Range1 &range1, Range2 &range2) {
+    return JoinedRange<const Range1, Range2>(range1, range2);
+}
+
+/// Return a joined range (1st range: const reference, 2nd range: right-value)
+template <typename Range1, typename Range2>
+[[maybe_unused]] [[nodiscard]] constexpr const JoinedRange<const Range1, Range2> join(const Range1 &range1, Range2 &&range2) {
+    return JoinedRange<const Range1, Range2>(range1, range2);
+}
+
+/// Return a joined range (1st range: const reference, 2nd range: const reference)
+template <typename Range1, typename Range2>
+[[maybe_unused]] [[nodiscard]] constexpr const JoinedRange<const Range1, const Range2> join(const Range1 &range1, const Range2 &range2) {
+    return JoinedRange<const Range1, const Range2>(range1, range2);
+}
+
+/// Whether an iterator walks a contiguous array of `T`: a pointer, an iterator of `std::vector` or `std::string`,
+/// or a C++20 contiguous iterator
+template <typename Iterator, typename T>
+struct [[maybe_unused]] is_contiguous_iterator: std::bool_constant<
+        std::is_same<Iterator, T*>::value or std::is_same<Iterator, const T*>::value or
+        std::is_same<Iterator, typename std::vector<T>::iterator>::value or
+        std::is_same<Iterator, typename std::vector<T>::const_iterator>::value or
+        (std::is_same<T, char>::value and (std::is_same<Iterator, std::string::iterator>::value or
+                                           std::is_same<Iterator, std::string::const_iterator>::value))
+#if defined(__cpp_lib_concepts)
+        or std::contiguous_iterator<Iterator>
+#endif
+        > {};
+
+/// Whether a range is a contiguous array of `T` (has `data()` and `size()`, and contiguous iterators)
+template <typename Range, typename T, typename = void>
+struct [[maybe_unused]] is_contiguous_range: std::false_type {};
+
+template <typename Range, typename T>
+struct [[maybe_unused]] is_contiguous_range<Range, T, std::void_t<decltype(std::declval<const Range&>().data()),
+        decltype(std::declval<const Range&>().size())>>: std::bool_constant<std::is_same<typename std::remove_cv<
+        typename std::remove_pointer<decltype(std::declval<const Range&>().data())>::type>::type, T>::value and
+        is_contiguous_iterator<decltype(std::declval<const Range&>().begin()), T>::value> {};
+
+/// A counting range of integers (`first`, `first + step`, ... before `last`), with random-access iterators
+template <typename T>
+class [[maybe_unused]] IotaRange {
+private:
+    static_assert(std::is_integral<T>::value, "IotaRange only supports integers");
+
+public:
+    [[maybe_unused]] typedef T value_type;
+    typedef typename std::make_signed<T>::type step_t;
+
+    /// The iterator type for `IotaRange`, the value is kept inside so that it can be referenced
+    struct [[maybe_unused]] Iterator {
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef std::ptrdiff_t difference_type;
+        typedef T value_type;
+        typedef const T* pointer;
+        typedef const T& reference;
+
+        T first, value;
+        step_t step;
+        difference_type index;
+
+        [[maybe_unused]] constexpr Iterator(T first, step_t step, difference_type index):
+                first(first), value(first), step(step), index(index) {
+            update();
+        }
+
+        constexpr void update() {
+            value = static_cast<T>(first + static_cast<T>(index) * static_cast<T>(step));
+        }
+
+        [[maybe_unused]] constexpr const T &operator *() const {
+            return value;
+        }
+
+        [[maybe_unused]] constexpr T operator [](difference_type offset) const {
+            return static_cast<T>(first + static_cast<T>(index + offset) * static_cast<T>(step));
+        }
+
+        [[maybe_unused]] constexpr Iterator &operator ++() {
+            ++ index, value = static_cast<T>(value + static_cast<T>(step));
+            return *this;
+        }
+
+        [[maybe_unused]] constexpr Iterator &operator --() {
+            -- index, value = static_cast<T>(value - static_cast<T>(step));
+            return *this;
+        }
+
+        [[maybe_unused]] constexpr Iterator operator ++(int) {
+            Iterator previous = *this;
+            ++ *this;
+            return previous;
+        }
+
+        [[maybe_unused]] constexpr Iterator operator --(int) {
+            Iterator previous = *this;
+            -- *this;
+            return previous;
+        }
+
+        [[maybe_unused]] constexpr Iterator &operator +=(difference_type offset) {
+            index += offset;
+            update();
+            return *this;
+        }
+
+        [[maybe_unused]] constexpr Iterator &operator -=(difference_type offset) {
+            return *this += -offset;
+        }
+
+        [[maybe_unused]] constexpr Iterator operator +(difference_type offset) const {
+            return Iterator(first, step, index + offset);
+        }
+
+        [[maybe_unused]] constexpr Iterator operator -(difference_type offset) const {
+            return Iterator(first, step, index - offset);
+        }
+
+        [[maybe_unused]] constexpr difference_type operator -(const Iterator &other) const {
+            return index - other.index;
+        }
+
+        [[maybe_unused]] constexpr bool operator ==(const Iterator &other) const {
+            return index == other.index;
+        }
+
+        [[maybe_unused]] constexpr bool operator !=(const Iterator &other) const {
+            return index != other.index;
+        }
+
+        [[maybe_unused]] constexpr bool operator <(const Iterator &other) const {
+            return index < other.index;
+        }
+
+        [[maybe_unused]] constexpr bool operator >(const Iterator &other) const {
+            return index > other.index;
+        }
+
+        [[maybe_unused]] constexpr bool operator <=(const Iterator &other) const {
+            return index <= other.index;
+        }
+
+        [[maybe_unused]] constexpr bool operator >=(const Iterator &other) const {
+            return index >= other.index;
+        }
+
+        [[maybe_unused]] friend constexpr Iterator operator +(difference_type offset, const Iterator &iterator) {
+            return iterator + offset;
+        }
+    };
+
+    typedef Iterator iterator;
+    typedef Iterator const_iterator;
+    typedef Iterator reverse_iterator;
+    typedef Iterator const_reverse_iterator;
+
+private:
+    T first;
+    step_t step;
+    size_t count = 0;
+
+public:
+    [[maybe_unused]] constexpr IotaRange(T first, T last, step_t step): first(first), step(step) {
+        assert(step != 0);
+        if (step > 0) {
+            count = last > first ? (static_cast<size_t>(last - first) + step - 1) / step : 0;
+        } else {
+            count = first > last ? (static_cast<size_t>(first - last) - step - 1) / static_cast<size_t>(-step) : 0;
+        }
+    }
+
+    /// Number of values (O(1))
+    [[maybe_unused]] [[nodiscard]] constexpr size_t size() const {
+        return count;
+    }
+
+    [[maybe_unused]] constexpr T operator [](size_t index) const {
+        assert(index < count);
+        return static_cast<T>(first + static_cast<T>(index) * static_cast<T>(step));
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr T front() const {
+        return first;
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr step_t stride() const {
+        return step;
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_iterator begin() const {
+        return const_iterator(first, step, 0);
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_iterator end() const {
+        return const_iterator(first, step, count);
+    }
+
+    /// Reversed iteration is counting with a negated step
+    [[maybe_unused]] [[nodiscard]] constexpr const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(count == 0 ? first : (*this)[count - 1], static_cast<step_t>(-step), 0);
+    }
+
+    [[maybe_unused]] [[nodiscard]] constexpr const_reverse_iterator rend() const {
+        return const_reverse_iterator(count == 0 ? first : (*this)[count - 1], static_cast<step_t>(-step), count);
+    }
+};
+
+/// Return a counting range [0, `n`)
+template <typename T>
+[[maybe_unused]] [[nodiscard]] constexpr IotaRange<T> iota(T n) {
+    return IotaRange<T>(0, n, 1);
+}
+
+/// Return a counting range [`first`, `last`) by `step` (may be negative)
+template <typename T>
+[[maybe_unused]] [[nodiscard]] constexpr IotaRange<T> iota(T first, T last, typename IotaRange<T>::step_t step=1) {
+    return IotaRange<T>(first, last, step);
+}
+
+/// A cartesian product of ranges, left values are referenced and right values are stored
+template <typename... Ranges>
+class [[maybe_unused]] ProductRange {
+private:
+    static_assert(sizeof...(Ranges) > 0, "ProductRange needs at least one range");
+
+    template <typename Range>
+    using iterator_of = decltype(std::declval<const typename std::remove_reference<Range>::type&>().begin());
+
+    std::tuple<Ranges...> ranges;
+
+    template <typename Range>
+    struct is_iota: std::false_type {};
+
+    template <typename T>
+    struct is_iota<IotaRange<T>>: std::true_type {};
+
+    /// Expand into nested loops, counting ranges become plain counted loops
+    template <size_t I, typename Function, typename... Values>
+    void nested(const Function &f, const Values&... values) const {
+        if constexpr (I == sizeof...(Ranges)) {
+            f(values...);
+        } else {
+            const auto &range = std::get<I>(ranges);
+            if constexpr (is_iota<typename std::decay<decltype(range)>::type>::value) {
+                size_t count = range.size();
+                auto value = range.front();
+                auto step = static_cast<decltype(value)>(range.stride());
+                for (size_t i = 0; i < count; ++ i, value += step) {
+                    nested<I + 1>(f, values..., value);
+                }
+            } else {
+                for (const auto &value: range) {
+                    nested<I + 1>(f, values..., value);
+                }
+            }
+        }
+    }
+
+public:
+    [[maybe_unused]] typedef std::tuple<typename std::decay<decltype(*std::declval<iterator_of<Ranges>>())>::type...> value_type;
+
+    /// The iterator type for `ProductRange` (the last range changes the fastest)
+    struct [[maybe_unused]] Iterator {
+        typedef std::forward_iterator_tag iterator_category;
+        typedef std::ptrdiff_t difference_type;
+        typedef ProductRange::value_type value_type;
+        typedef const value_type* pointer;
+        typedef const value_type& reference;
+
+        std::tuple<iterator_of<Ranges>...> begins, iterators, ends;
+        value_type value;
+        bool done;
+
+        template <size_t... I>
+        void load(std::index_sequence<I...>) {
+            value = value_type(*std::get<I>(iterators)...);
+        }
+
+        template <size_t I>
+        bool advance() {
+            if constexpr (I == 0) {
+                return ++ std::get<0>(iterators) != std::get<0>(ends);
+            } else {
+                if (++ std::get<I>(iterators) != std::get<I>(ends)) {
+                    return true;
+                }
+                std::get<I>(iterators) = std::get<I>(begins);
+                return advance<I - 1>();
+            }
+        }
+
+        template <size_t... I>
+        [[nodiscard]] bool any_empty(std::index_sequence<I...>) const {
+            return ((std::get<I>(begins) == std::get<I>(ends)) or ...);
+        }
+
+        [[maybe_unused]] Iterator(const std::tuple<iterator_of<Ranges>...> &begins,
+                                  const std::tuple<iterator_of<Ranges>...> &ends, bool done):
+                begins(begins), iterators(begins), ends(ends), done(done) {
+            this->done = done or any_empty(std::index_sequence_for<Ranges...>());
+            if (not this->done) {
+                load(std::index_sequence_for<Ranges...>());
+            }
+        }
+
+        [[maybe_unused]] const value_type &operator *() const {
+            return value;
+        }
+
+        [[maybe_unused]] Iterator &operator ++() {
+            done = not advance<sizeof...(Ranges) - 1>();
+            if (not done) {
+                load(std::index_sequence_for<Ranges...>());
+            }
+            return *this;
+        }
+
+        [[maybe_unused]] bool operator ==(const Iterator &other) const {
+            return done == other.done and (done or iterators == other.iterators);
+        }
+
+        [[maybe_unused]] bool operator !=(const Iterator &other) const {
+            return not (*this == other);
+        }
+    };
+
+    typedef Iterator iterator;
+    typedef Iterator const_iterator;
+
+    template <typename... Args>
+    [[maybe_unused]] explicit ProductRange(Args&&... args): ranges(std::forward<Args>(args)...) {}
+
+    [[maybe_unused]] [[nodiscard]] const_iterator begin() const {
+        return std::apply([](const auto&... range) {
+            return const_iterator({range.begin()...}, {range.end()...}, false);
+        }, ranges);
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator end() const {
+        return std::apply([](const auto&... range) {
+            return const_iterator({range.begin()...}, {range.end()...}, true);
+        }, ranges);
+    }
+
+    /// Call `f(values...)` for every combination as plain nested loops
+    template <typename Function>
+    [[maybe_unused]] void for_each(const Function &f) const {
+        nested<0>(f);
+    }
+};
+
+/// Return a cartesian product of ranges
+template <typename... Ranges>
+[[maybe_unused]] [[nodiscard]] ProductRange<Ranges...> product(Ranges&&... ranges) {
+    return ProductRange<Ranges...>(std::forward<Ranges>(ranges)...);
+}
+
+/// For each combination of a cartesian product as `f(values...)`, lowered to nested loops (const reference)
+template <typename... Ranges, typename Function>
+[[maybe_unused]] void for_each(const ProductRange<Ranges...> &range, const Function &f) {
+    range.for_each(f);
+}
+
+/// For each combination of a cartesian product as `f(values...)`, lowered to nested loops (left-value reference)
+template <typename... Ranges, typename Function>
+[[maybe_unused]] void for_each(ProductRange<Ranges...> &range, const Function &f) {
+    range.for_each(f);
+}
+
+/// For each combination of a cartesian product as `f(values...)`, lowered to nested loops (right-value)
+template <typename... Ranges, typename Function>
+[[maybe_unused]] void for_each(ProductRange<Ranges...> &&range, const Function &f) {
+    range.for_each(f);
+}
+
+} // namespace cherry
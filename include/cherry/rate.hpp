@@ -0,0 +1,217 @@
+/*
+ * Cherry: rate limiting and throughput metering
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+#include "pretty.hpp"
+
+namespace cherry {
+
+/// A lock-free token bucket rate limiter, the tokens and the refill timestamp are packed into one atomic word
+/// (the packed timestamp wraps every 12.7 days, so a bucket idle for longer than half of it is refilled to full)
+class [[maybe_unused]] TokenBucket {
+private:
+    // Lower bits are tokens, higher bits are the last refill time (microseconds since construction)
+    static constexpr int token_bits = 24;
+    static constexpr uint64_t token_mask = (1ull << token_bits) - 1;
+    static constexpr uint64_t time_mask = (1ull << (64 - token_bits)) - 1;
+
+    std::atomic<uint64_t> state;
+    // The unwrapped time of the last update of `state`, to detect long idle periods
+    std::atomic<uint64_t> last_update{0};
+    std::chrono::steady_clock::time_point origin;
+    uint64_t burst;
+    double tokens_per_us, us_per_token;
+
+    [[nodiscard]] static inline uint64_t pack(uint64_t time, uint64_t tokens) {
+        return ((time & time_mask) << token_bits) | tokens;
+    }
+
+    [[nodiscard]] inline uint64_t now() const {
+        auto duration = std::chrono::steady_clock::now() - origin;
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    }
+
+    /// Whether the bucket has not been updated for so long that the packed timestamp may have wrapped
+    [[nodiscard]] inline bool idle_since(uint64_t time) const {
+        return time - last_update.load(std::memory_order_relaxed) > (time_mask >> 1u);
+    }
+
+    /// Refill the tokens in an unpacked state, return the new packed state
+    [[nodiscard]] inline uint64_t refill(uint64_t old_state, uint64_t time) const {
+        time &= time_mask;
+        uint64_t tokens = old_state & token_mask, last = old_state >> token_bits;
+        uint64_t elapsed = (time - last) & time_mask;
+        // Another thread has stored a later time point
+        if (elapsed > (time_mask >> 1u)) {
+            return old_state;
+        }
+        auto added = static_cast<uint64_t>(static_cast<double>(elapsed) * tokens_per_us);
+        if (added == 0) {
+            return old_state;
+        }
+        if (tokens + added >= burst) {
+            return pack(time, burst);
+        }
+        // Only consume the time of whole tokens, so that the fractional part is kept for the next refill
+        return pack(last + static_cast<uint64_t>(static_cast<double>(added) * us_per_token), tokens + added);
+    }
+
+public:
+    /// Max burst capacity supported by the packed state
+    [[maybe_unused]] static constexpr uint64_t max_burst = token_mask;
+
+    /// `rate` is tokens per second, `burst` is the capacity (the bucket is full at the beginning)
+    [[maybe_unused]] TokenBucket(double rate, uint64_t burst): burst(burst) {
+        assert(rate > 0 and burst > 0 and burst <= max_burst);
+        tokens_per_us = rate / 1e6;
+        us_per_token = 1e6 / rate;
+        origin = std::chrono::steady_clock::now();
+        state.store(pack(0, burst), std::memory_order_relaxed);
+    }
+
+    /// Try to take `n` tokens without blocking, return whether succeeded
+    [[maybe_unused]] [[nodiscard]] bool try_acquire(uint64_t n=1) {
+        uint64_t time = now();
+        uint64_t old_state = state.load(std::memory_order_relaxed);
+        bool idle = idle_since(time);
+        while (true) {
+            uint64_t new_state = idle ? pack(time, burst) : refill(old_state, time);
+            if ((new_state & token_mask) < n) {
+                return false;
+            }
+            uint64_t expected = old_state;
+            if (state.compare_exchange_weak(old_state, new_state - n, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                last_update.store(time, std::memory_order_relaxed);
+                return true;
+            }
+            // Only one thread refills after an idle period, the others refill from its state
+            idle = idle and old_state == expected;
+        }
+    }
+
+    /// Tokens currently available (a snapshot)
+    [[maybe_unused]] [[nodiscard]] uint64_t available() const {
+        uint64_t time = now();
+        return idle_since(time) ? burst : refill(state.load(std::memory_order_relaxed), time) & token_mask;
+    }
+
+    /// The burst capacity
+    [[maybe_unused]] [[nodiscard]] uint64_t capacity() const {
+        return burst;
+    }
+};
+
+/// A throughput meter with exponentially weighted moving averages over 1/5/15-second windows
+class [[maybe_unused]] RateMeter {
+private:
+    static constexpr int shards = 32;
+    static constexpr uint64_t interval = 100000000ull; // 100 ms in nanoseconds
+    static constexpr double windows[3] = {1.0, 5.0, 15.0};
+
+    /// A counter owning a whole cache line, so that threads do not share lines when marking
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> count{0};
+    };
+
+    Shard counters[shards];
+    std::chrono::steady_clock::time_point origin;
+    std::atomic<uint64_t> last_tick{0}, total{0};
+    std::atomic<double> rates[3] = {0.0, 0.0, 0.0};
+
+    /// The shard of the current thread (threads are assigned in round-robin order)
+    [[nodiscard]] static inline int shard_index() {
+        static std::atomic<int> next{0};
+        thread_local int index = next.fetch_add(1, std::memory_order_relaxed) % shards;
+        return index;
+    }
+
+    [[nodiscard]] inline uint64_t now() const {
+        auto duration = std::chrono::steady_clock::now() - origin;
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    }
+
+    /// Fold the shards into the moving averages if one or more intervals have passed (only one thread does it)
+    inline void tick_if_necessary() {
+        uint64_t last = last_tick.load(std::memory_order_acquire), time = now();
+        uint64_t ticks = (time - last) / interval;
+        if (ticks == 0) {
+            return;
+        }
+        if (not last_tick.compare_exchange_strong(last, last + ticks * interval, std::memory_order_acq_rel)) {
+            return;
+        }
+        uint64_t count = 0;
+        for (auto &shard: counters) {
+            count += shard.count.exchange(0, std::memory_order_relaxed);
+        }
+        total.fetch_add(count, std::memory_order_relaxed);
+        // Spread the count uniformly over the passed intervals
+        double rate = static_cast<double>(count) / (static_cast<double>(ticks * interval) / 1e9);
+        for (int i = 0; i < 3; ++ i) {
+            double decay = std::exp(-static_cast<double>(ticks * interval) / 1e9 / windows[i]);
+            double old_rate = rates[i].load(std::memory_order_relaxed);
+            rates[i].store(rate + (old_rate - rate) * decay, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    [[maybe_unused]] RateMeter() {
+        origin = std::chrono::steady_clock::now();
+    }
+
+    /// Record `n` events (only a relaxed increment on the thread's own shard)
+    [[maybe_unused]] inline void mark(uint64_t n=1) {
+        counters[shard_index()].count.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /// The moving average rate (per second) over the last 1 second
+    [[maybe_unused]] [[nodiscard]] double rate1() {
+        tick_if_necessary();
+        return rates[0].load(std::memory_order_relaxed);
+    }
+
+    /// The moving average rate (per second) over the last 5 seconds
+    [[maybe_unused]] [[nodiscard]] double rate5() {
+        tick_if_necessary();
+        return rates[1].load(std::memory_order_relaxed);
+    }
+
+    /// The moving average rate (per second) over the last 15 seconds
+    [[maybe_unused]] [[nodiscard]] double rate15() {
+        tick_if_necessary();
+        return rates[2].load(std::memory_order_relaxed);
+    }
+
+    /// The mean rate (per second) since construction
+    [[maybe_unused]] [[nodiscard]] double mean_rate() {
+        return static_cast<double>(count()) / (static_cast<double>(now()) / 1e9);
+    }
+
+    /// The number of events recorded since construction
+    [[maybe_unused]] [[nodiscard]] uint64_t count() {
+        uint64_t count = total.load(std::memory_order_relaxed);
+        for (auto &shard: counters) {
+            count += shard.count.load(std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+    /// Convert the moving averages to `std::string` with units
+    [[maybe_unused]] [[nodiscard]] std::string pretty() {
+        std::string text = "[1s: " + pretty_rate(rate1());
+        text += ", 5s: " + pretty_rate(rate5());
+        text += ", 15s: " + pretty_rate(rate15()) + "]";
+        return text;
+    }
+};
+
+} // namespace cherry
@@ -0,0 +1,244 @@
+/*
+ * Cherry: buffered output sinks writing to file descriptors (no iostreams)
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <sys/uio.h>
+#include <type_traits>
+#include <unistd.h>
+
+namespace cherry {
+
+/// Whether a value is formatted by `format_value` or written as a string by `Sink`
+template <typename T>
+struct [[maybe_unused]] is_sink_formattable: std::integral_constant<bool,
+        std::is_arithmetic<T>::value or std::is_pointer<T>::value or std::is_convertible<const T&, std::string_view>::value> {};
+
+/// Maximum characters of a value formatted by `format_value`
+static constexpr size_t max_formatted_length = 64;
+
+/// Format a number, character or pointer into [`first`, `first + max_formatted_length`) like `std::ostream` does
+/// by default (e.g. 6 significant digits for floating points), return the end
+template <typename T>
+[[maybe_unused]] static inline char *format_value(char *first, const T &value) {
+    char *last = first + max_formatted_length;
+    if constexpr (std::is_same<T, bool>::value) {
+        *first = value ? '1' : '0';
+        return first + 1;
+    } else if constexpr (std::is_same<T, char>::value or std::is_same<T, signed char>::value or
+                         std::is_same<T, unsigned char>::value) {
+        *first = static_cast<char>(value);
+        return first + 1;
+    } else if constexpr (std::is_integral<T>::value) {
+        return std::to_chars(first, last, value).ptr;
+    } else if constexpr (std::is_floating_point<T>::value) {
+        return std::to_chars(first, last, value, std::chars_format::general, 6).ptr;
+    } else {
+        static_assert(std::is_pointer<T>::value, "Unsupported type for format_value");
+        if (value == nullptr) {
+            *first = '0';
+            return first + 1;
+        }
+        first[0] = '0', first[1] = 'x';
+        return std::to_chars(first + 2, last, reinterpret_cast<uintptr_t>(value), 16).ptr;
+    }
+}
+
+/// When a `Sink` writes its buffer into the file descriptor (besides when the buffer is full)
+enum class FlushPolicy {
+    full,   // Only when full or `flush()`
+    line,   // After every print containing a line break
+    always  // After every print
+};
+
+/// A thread-safe buffered output sink on a file descriptor, values are formatted by `std::to_chars` into the buffer,
+/// and a disabled sink returns before formatting anything
+class [[maybe_unused]] Sink {
+private:
+    int fd;
+    FlushPolicy policy;
+    size_t capacity, used = 0;
+    std::unique_ptr<char[]> buffer;
+    std::atomic<bool> enabled = true;
+    bool failed = false, line_break = false;
+    std::mutex mutex;
+
+    /// The standard output sink once created, for the fatal signal path
+    static inline std::atomic<Sink*> standard_output_sink{nullptr};
+
+    void write_locked(const char *data, size_t size) {
+        while (size > 0) {
+            ssize_t written = ::write(fd, data, size);
+            if (written <= 0) {
+                failed = true;
+                return;
+            }
+            data += written, size -= written;
+        }
+    }
+
+    void flush_locked() {
+        write_locked(buffer.get(), used);
+        used = 0;
+    }
+
+    void append_locked(const char *data, size_t size) {
+        line_break = line_break or (policy == FlushPolicy::line and std::memchr(data, '\n', size) != nullptr);
+        if (used + size <= capacity) {
+            std::memcpy(buffer.get() + used, data, size);
+            used += size;
+            return;
+        }
+        // Large data goes with the buffered bytes in one `writev` without copying
+        struct iovec vectors[2] = {{buffer.get(), used}, {const_cast<char*>(data), size}};
+        ssize_t written = writev(fd, vectors, 2);
+        if (written < 0) {
+            failed = true;
+        } else if (static_cast<size_t>(written) < used + size) {
+            // Partial write
+            auto count = static_cast<size_t>(written);
+            if (count < used) {
+                write_locked(buffer.get() + count, used - count);
+                count = used;
+            }
+            write_locked(data + (count - used), size - (count - used));
+        }
+        used = 0;
+    }
+
+    template <typename T>
+    void format_locked(const T &value) {
+        if constexpr (std::is_convertible<const T&, std::string_view>::value) {
+            std::string_view text = value;
+            append_locked(text.data(), text.size());
+        } else {
+            if (capacity - used < max_formatted_length) {
+                flush_locked();
+            }
+            char *end = format_value(buffer.get() + used, value);
+            line_break = line_break or (policy == FlushPolicy::line and std::is_same<T, char>::value and value == '\n');
+            used = end - buffer.get();
+        }
+    }
+
+public:
+    static constexpr size_t default_capacity = 64 * 1024;
+
+    /// A sink on `fd` (not owned) with a buffer of `capacity` bytes (at least `max_formatted_length`)
+    [[maybe_unused]] explicit Sink(int fd, FlushPolicy policy=FlushPolicy::full, size_t capacity=default_capacity):
+            fd(fd), policy(policy), capacity(std::max(capacity, max_formatted_length)), buffer(new char[this->capacity]) {}
+
+    Sink(const Sink &) = delete;
+
+    Sink &operator =(const Sink &) = delete;
+
+    [[maybe_unused]] ~Sink() {
+        flush();
+    }
+
+    /// The sink of the standard output (flushed by lines on terminals, otherwise when full or at exit)
+    [[maybe_unused]] static Sink &standard_output() {
+        static Sink sink(STDOUT_FILENO, isatty(STDOUT_FILENO) ? FlushPolicy::line : FlushPolicy::full);
+        static bool registered = (standard_output_sink.store(&sink, std::memory_order_release), true);
+        static_cast<void>(registered);
+        return sink;
+    }
+
+    /// The sink of the standard error (flushed after every print)
+    [[maybe_unused]] static Sink &standard_error() {
+        static Sink sink(STDERR_FILENO, FlushPolicy::always);
+        return sink;
+    }
+
+    /// Enable or disable the sink (a disabled sink discards without formatting)
+    [[maybe_unused]] void enable(bool enable=true) {
+        enabled = enable;
+    }
+
+    [[maybe_unused]] [[nodiscard]] bool is_enabled() const {
+        return enabled;
+    }
+
+    /// Whether writing failed
+    [[maybe_unused]] [[nodiscard]] bool fail() const {
+        return failed;
+    }
+
+    /// Bytes buffered and not written yet
+    [[maybe_unused]] [[nodiscard]] size_t buffered() const {
+        return used;
+    }
+
+    /// Print all the values (numbers, characters, pointers and strings) without separators
+    template <typename... Args>
+    [[maybe_unused]] void print(const Args&... args) {
+        static_assert((is_sink_formattable<Args>::value and ...), "Sink only formats numbers, pointers and strings");
+        if (not enabled) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard(mutex);
+        (format_locked(args), ...);
+        if (policy == FlushPolicy::always or line_break) {
+            flush_locked();
+        }
+        line_break = false;
+    }
+
+    /// Print all the values with `separator` between them
+    template <typename Arg, typename... Args>
+    [[maybe_unused]] void print_separated(std::string_view separator, const Arg &arg, const Args&... args) {
+        static_assert(is_sink_formattable<Arg>::value and (is_sink_formattable<Args>::value and ...),
+                      "Sink only formats numbers, pointers and strings");
+        if (not enabled) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard(mutex);
+        format_locked(arg);
+        ((format_locked(separator), format_locked(args)), ...);
+        if (policy == FlushPolicy::always or line_break) {
+            flush_locked();
+        }
+        line_break = false;
+    }
+
+    /// Write raw bytes
+    [[maybe_unused]] void write(const char *data, size_t size) {
+        if (not enabled) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard(mutex);
+        append_locked(data, size);
+        if (policy == FlushPolicy::always or line_break) {
+            flush_locked();
+        }
+        line_break = false;
+    }
+
+    /// Write the buffered bytes into the file descriptor
+    [[maybe_unused]] void flush() {
+        std::lock_guard<std::mutex> guard(mutex);
+        flush_locked();
+    }
+
+    /// Write the buffered bytes of the standard output sink (if created) with plain `write` calls and without
+    /// locking, only for fatal signal handlers (async-signal-safe, a print in progress may be cut)
+    [[maybe_unused]] static void flush_standard_output_on_signal() {
+        Sink *sink = standard_output_sink.load(std::memory_order_acquire);
+        if (sink != nullptr) {
+            sink->flush_locked();
+        }
+    }
+};
+
+} // namespace cherry
@@ -0,0 +1,394 @@
+/*
+ * Cherry: lock-free skip list ordered set and map
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "epoch.hpp"
+
+namespace cherry {
+
+/// A lock-free ordered set (if `Value` is `void`) or map of unique keys by a skip list (Harris-style marked links):
+/// lookups never retry (wait-free while fewer threads than the epoch slots hold guards), insertion and erasure are
+/// lock-free, and the erased nodes are reclaimed by epochs
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class [[maybe_unused]] SkipList {
+private:
+    static constexpr bool is_map = not std::is_void<Value>::value;
+    typedef typename std::conditional<is_map, Value, char>::type stored_t;
+
+public:
+    /// The most levels of a node
+    static constexpr int max_height = 24;
+
+private:
+    // `next` lives right after the node in the same allocation, the lowest bit of a link marks the node as erased
+    struct Node {
+        Key key;
+        stored_t value;
+        int height;
+        // The inserting and the erasing threads both finish here, the second unlinks and retires the node
+        std::atomic<int> finished = 0;
+        std::atomic<uintptr_t> *next;
+
+        template <typename... Args>
+        Node(int height, const Key &key, Args&&... args):
+                key(key), value(std::forward<Args>(args)...), height(height),
+                next(reinterpret_cast<std::atomic<uintptr_t>*>(this + 1)) {
+            for (int level = 0; level < height; ++ level) {
+                new (next + level) std::atomic<uintptr_t>(0);
+            }
+        }
+    };
+
+    std::atomic<uintptr_t> head[max_height];
+    std::atomic<int64_t> total = 0;
+    mutable EpochManager epochs;
+    Compare compare;
+
+    static bool marked(uintptr_t link) {
+        return link & 1;
+    }
+
+    static Node *to_node(uintptr_t link) {
+        return reinterpret_cast<Node*>(link & ~static_cast<uintptr_t>(1));
+    }
+
+    static uintptr_t bits(Node *node) {
+        return reinterpret_cast<uintptr_t>(node);
+    }
+
+    // The link at `level` after `node` (the head if null)
+    std::atomic<uintptr_t> &link(Node *node, int level) {
+        return node != nullptr ? node->next[level] : head[level];
+    }
+
+    template <typename... Args>
+    static Node *create_node(int height, const Key &key, Args&&... args) {
+        void *memory = ::operator new(sizeof(Node) + height * sizeof(std::atomic<uintptr_t>));
+        return new (memory) Node(height, key, std::forward<Args>(args)...);
+    }
+
+    static void destroy_node(void *memory) {
+        static_cast<Node*>(memory)->~Node();
+        ::operator delete(memory);
+    }
+
+    // A geometric height with p = 1/4
+    static int random_height() {
+        static thread_local uint64_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+        state ^= state << 13, state ^= state >> 7, state ^= state << 17;
+        return 1 + __builtin_ctzll(state | (uint64_t(1) << (2 * max_height - 2))) / 2;
+    }
+
+    // Find the predecessors and successors of `key` at all the levels, unlinking the marked nodes on the way,
+    // return whether `succs[0]` holds `key`
+    bool find(const Key &key, Node **preds, Node **succs) {
+        retry:
+        Node *pred = nullptr;
+        for (int level = max_height - 1; level >= 0; -- level) {
+            Node *current = to_node(link(pred, level).load(std::memory_order_acquire));
+            while (current != nullptr) {
+                uintptr_t next = current->next[level].load(std::memory_order_acquire);
+                while (marked(next)) {
+                    uintptr_t expected = bits(current);
+                    if (not link(pred, level).compare_exchange_strong(expected, next & ~uintptr_t(1))) {
+                        goto retry;
+                    }
+                    current = to_node(next);
+                    if (current == nullptr) {
+                        break;
+                    }
+                    next = current->next[level].load(std::memory_order_acquire);
+                }
+                if (current == nullptr or not compare(current->key, key)) {
+                    break;
+                }
+                pred = current, current = to_node(next);
+            }
+            preds[level] = pred, succs[level] = current;
+        }
+        return succs[0] != nullptr and not compare(key, succs[0]->key);
+    }
+
+    // The first unmarked node not less than `key` (the first unmarked one if `key` is null), without writing anything
+    Node *search(const Key *key) const {
+        auto self = const_cast<SkipList*>(this);
+        Node *pred = nullptr, *current = nullptr;
+        for (int level = key != nullptr ? max_height - 1 : 0; level >= 0; -- level) {
+            current = to_node(self->link(pred, level).load(std::memory_order_acquire));
+            while (current != nullptr) {
+                uintptr_t next = current->next[level].load(std::memory_order_acquire);
+                // Skip the marked nodes
+                if (marked(next)) {
+                    current = to_node(next);
+                    continue;
+                }
+                if (key == nullptr or not compare(current->key, *key)) {
+                    break;
+                }
+                pred = current, current = to_node(next);
+            }
+        }
+        return current;
+    }
+
+    // The inserting or the erasing thread finished with `node`, the second one unlinks it and retires it
+    void finish(Node *node, EpochManager::Guard &guard) {
+        if (node->finished.fetch_add(1) == 1 and marked(node->next[0].load())) {
+            Node *preds[max_height], *succs[max_height];
+            find(node->key, preds, succs);
+            guard.retire(node, &destroy_node);
+        }
+    }
+
+    template <typename... Args>
+    bool emplace(const Key &key, Args&&... args) {
+        auto guard = epochs.pin();
+        Node *preds[max_height], *succs[max_height];
+        Node *node = nullptr;
+        int height = random_height();
+        while (true) {
+            if (find(key, preds, succs)) {
+                if (node != nullptr) {
+                    destroy_node(node);
+                }
+                return false;
+            }
+            if (node == nullptr) {
+                node = create_node(height, key, std::forward<Args>(args)...);
+            }
+            for (int level = 0; level < height; ++ level) {
+                node->next[level].store(bits(succs[level]), std::memory_order_relaxed);
+            }
+            uintptr_t expected = bits(succs[0]);
+            if (link(preds[0], 0).compare_exchange_strong(expected, bits(node))) {
+                break;
+            }
+        }
+        ++ total;
+        // Link the upper levels until done or erased concurrently
+        for (int level = 1; level < height; ++ level) {
+            while (true) {
+                uintptr_t next = node->next[level].load();
+                if (marked(next) or (next != bits(succs[level]) and
+                                     not node->next[level].compare_exchange_strong(next, bits(succs[level])))) {
+                    finish(node, guard);
+                    return true;
+                }
+                uintptr_t expected = bits(succs[level]);
+                if (link(preds[level], level).compare_exchange_strong(expected, bits(node))) {
+                    break;
+                }
+                if (not find(key, preds, succs) or succs[0] != node) {
+                    finish(node, guard);
+                    return true;
+                }
+            }
+        }
+        finish(node, guard);
+        return true;
+    }
+
+public:
+    /// A range of the items in [`from`, `to`), which pins the epoch while alive (so keep it short-lived),
+    /// items erased concurrently may or may not be visited
+    class [[maybe_unused]] ScanRange {
+    private:
+        friend class SkipList;
+
+        const SkipList *list;
+        EpochManager::Guard guard;
+        Node *first;
+        std::optional<Key> to;
+
+        ScanRange(const SkipList *list, EpochManager::Guard &&guard, const Key *from, const Key *to):
+                list(list), guard(std::move(guard)), first(nullptr) {
+            if (to != nullptr) {
+                this->to = *to;
+            }
+            first = skip(list->search(from));
+        }
+
+        // The first live node from `node` in the range
+        Node *skip(Node *node) const {
+            while (node != nullptr and marked(node->next[0].load(std::memory_order_acquire))) {
+                node = to_node(node->next[0].load(std::memory_order_acquire));
+            }
+            if (node != nullptr and to.has_value() and not list->compare(node->key, *to)) {
+                return nullptr;
+            }
+            return node;
+        }
+
+    public:
+        typedef typename std::conditional<is_map, std::pair<Key, stored_t>, Key>::type value_type;
+        typedef typename std::conditional<is_map, std::pair<const Key&, const stored_t&>, const Key&>::type reference;
+
+        /// The forward iterator type for `ScanRange`
+        struct [[maybe_unused]] Iterator {
+            const ScanRange *range;
+            Node *node;
+
+            typedef std::forward_iterator_tag iterator_category;
+            typedef ScanRange::value_type value_type;
+            typedef ScanRange::reference reference;
+            typedef void pointer;
+            typedef ptrdiff_t difference_type;
+
+            [[maybe_unused]] reference operator *() const {
+                if constexpr (is_map) {
+                    return reference(node->key, node->value);
+                } else {
+                    return node->key;
+                }
+            }
+
+            [[maybe_unused]] Iterator &operator ++() {
+                node = range->skip(to_node(node->next[0].load(std::memory_order_acquire)));
+                return *this;
+            }
+
+            [[maybe_unused]] Iterator operator ++(int) {
+                Iterator copy = *this;
+                ++ *this;
+                return copy;
+            }
+
+            [[maybe_unused]] bool operator ==(const Iterator &other) const {
+                return node == other.node;
+            }
+
+            [[maybe_unused]] bool operator !=(const Iterator &other) const {
+                return node != other.node;
+            }
+        };
+
+        typedef Iterator iterator;
+        typedef Iterator const_iterator;
+
+        [[maybe_unused]] [[nodiscard]] Iterator begin() const {
+            return {this, first};
+        }
+
+        [[maybe_unused]] [[nodiscard]] Iterator end() const {
+            return {this, nullptr};
+        }
+    };
+
+    [[maybe_unused]] explicit SkipList(const Compare &compare=Compare()): compare(compare) {
+        for (auto &link: head) {
+            link.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    SkipList(const SkipList &) = delete;
+
+    SkipList &operator =(const SkipList &) = delete;
+
+    /// Free all the nodes (no other thread may use the list)
+    ~SkipList() {
+        for (Node *node = to_node(head[0].load()), *next; node != nullptr; node = next) {
+            next = to_node(node->next[0].load());
+            destroy_node(node);
+        }
+    }
+
+    /// Insert a key (set), return whether it was absent
+    template <bool map = is_map, typename = typename std::enable_if<not map>::type>
+    [[maybe_unused]] bool insert(const Key &key) {
+        return emplace(key);
+    }
+
+    /// Insert a key with its value (map), return whether the key was absent
+    template <typename V, bool map = is_map, typename = typename std::enable_if<map>::type>
+    [[maybe_unused]] bool insert(const Key &key, V &&value) {
+        return emplace(key, std::forward<V>(value));
+    }
+
+    /// Erase a key, return whether this call erased it
+    [[maybe_unused]] bool erase(const Key &key) {
+        auto guard = epochs.pin();
+        Node *preds[max_height], *succs[max_height];
+        if (not find(key, preds, succs)) {
+            return false;
+        }
+        Node *node = succs[0];
+        for (int level = node->height - 1; level > 0; -- level) {
+            uintptr_t next = node->next[level].load();
+            while (not marked(next) and not node->next[level].compare_exchange_weak(next, next | 1));
+        }
+        // Marking the lowest level erases the key
+        uintptr_t next = node->next[0].load();
+        while (true) {
+            if (marked(next)) {
+                return false;
+            }
+            if (node->next[0].compare_exchange_weak(next, next | 1)) {
+                break;
+            }
+        }
+        -- total;
+        finish(node, guard);
+        return true;
+    }
+
+    /// Whether `key` is in the list (wait-free while an epoch slot is free)
+    [[maybe_unused]] [[nodiscard]] bool contains(const Key &key) const {
+        auto guard = epochs.pin();
+        Node *node = search(&key);
+        return node != nullptr and not compare(key, node->key);
+    }
+
+    /// A copy of the value of `key` (map)
+    template <bool map = is_map, typename = typename std::enable_if<map>::type>
+    [[maybe_unused]] [[nodiscard]] std::optional<stored_t> get(const Key &key) const {
+        auto guard = epochs.pin();
+        Node *node = search(&key);
+        if (node != nullptr and not compare(key, node->key)) {
+            return node->value;
+        }
+        return std::nullopt;
+    }
+
+    /// The items in [`from`, `to`) in order
+    [[maybe_unused]] [[nodiscard]] ScanRange scan(const Key &from, const Key &to) const {
+        return ScanRange(this, epochs.pin(), &from, &to);
+    }
+
+    /// All the items in order
+    [[maybe_unused]] [[nodiscard]] ScanRange scan() const {
+        return ScanRange(this, epochs.pin(), nullptr, nullptr);
+    }
+
+    /// Number of items (exact when no operation is in progress)
+    [[maybe_unused]] [[nodiscard]] size_t size() const {
+        return static_cast<size_t>(std::max<int64_t>(0, total.load(std::memory_order_relaxed)));
+    }
+
+    [[maybe_unused]] [[nodiscard]] bool empty() const {
+        return size() == 0;
+    }
+};
+
+/// A lock-free ordered set by skip list
+template <typename Key, typename Compare = std::less<Key>>
+using SkipListSet = SkipList<Key, void, Compare>;
+
+/// A lock-free ordered map by skip list
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+using SkipListMap = SkipList<Key, Value, Compare>;
+
+} // namespace cherry
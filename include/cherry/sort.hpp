@@ -0,0 +1,283 @@
+/*
+ * Cherry: sorting networks and small-array sort kernels
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ranges.hpp"
+
+namespace cherry {
+
+/// A comparator (compare-exchange) of a sorting network, `i < j`
+struct [[maybe_unused]] Comparator {
+    uint8_t i, j;
+};
+
+/// Best known networks for 10 (Waksman), 12 (Shapiro and Green) and 16 (Green) items,
+/// smaller networks are obtained by dropping the highest wires
+static constexpr Comparator best_known_network10[] = {
+        {0, 8}, {1, 9}, {2, 7}, {3, 5}, {4, 6}, {0, 2}, {1, 4}, {5, 8}, {7, 9}, {0, 3}, {2, 4}, {5, 7}, {6, 9},
+        {0, 1}, {3, 6}, {8, 9}, {1, 5}, {2, 3}, {4, 8}, {6, 7}, {1, 2}, {3, 5}, {4, 6}, {7, 8}, {2, 3}, {4, 5},
+        {6, 7}, {3, 4}, {5, 6}};
+static constexpr Comparator best_known_network12[] = {
+        {0, 8}, {1, 7}, {2, 6}, {3, 11}, {4, 10}, {5, 9}, {0, 1}, {2, 5}, {3, 4}, {6, 9}, {7, 8}, {10, 11},
+        {0, 2}, {1, 6}, {5, 10}, {9, 11}, {0, 3}, {1, 2}, {4, 6}, {5, 7}, {8, 11}, {9, 10}, {1, 4}, {3, 5},
+        {6, 8}, {7, 10}, {1, 3}, {2, 5}, {6, 9}, {8, 10}, {2, 3}, {4, 5}, {6, 7}, {8, 9}, {4, 6}, {5, 7},
+        {3, 4}, {5, 6}, {7, 8}};
+static constexpr Comparator best_known_network16[] = {
+        {0, 13}, {1, 12}, {2, 15}, {3, 14}, {4, 8}, {5, 6}, {7, 11}, {9, 10}, {0, 5}, {1, 7}, {2, 9}, {3, 4},
+        {6, 13}, {8, 14}, {10, 15}, {11, 12}, {0, 1}, {2, 3}, {4, 5}, {6, 8}, {7, 9}, {10, 11}, {12, 13},
+        {14, 15}, {0, 2}, {1, 3}, {4, 10}, {5, 11}, {6, 7}, {8, 9}, {12, 14}, {13, 15}, {1, 2}, {3, 12},
+        {4, 6}, {5, 7}, {8, 10}, {9, 11}, {13, 14}, {1, 4}, {2, 6}, {5, 8}, {7, 10}, {9, 13}, {11, 14},
+        {2, 4}, {3, 6}, {9, 12}, {11, 13}, {3, 5}, {6, 8}, {7, 9}, {10, 12}, {3, 4}, {5, 6}, {7, 8}, {9, 10},
+        {11, 12}, {6, 7}, {8, 9}};
+
+/// Visit the comparators of a sorting network for `n` items as `f(i, j)`: Batcher's odd-even merge sort
+/// (which is size-optimal up to 8 items), or a best known network with the wires from `n` dropped
+template <typename Function>
+[[maybe_unused]] static constexpr void visit_sorting_network(size_t n, const Function &f) {
+    if (n <= 8) {
+        for (size_t p = 1; p < n; p <<= 1) {
+            for (size_t k = p; k >= 1; k >>= 1) {
+                for (size_t j = k % p; j + k < n; j += 2 * k) {
+                    for (size_t i = 0; i < std::min(k, n - j - k); ++ i) {
+                        if ((i + j) / (2 * p) == (i + j + k) / (2 * p)) {
+                            f(i + j, i + j + k);
+                        }
+                    }
+                }
+            }
+        }
+        return;
+    }
+    auto visit = [n, &f](const auto &network) {
+        for (const auto &comparator: network) {
+            if (comparator.j < n) {
+                f(comparator.i, comparator.j);
+            }
+        }
+    };
+    if (n <= 10) {
+        visit(best_known_network10);
+    } else if (n <= 12) {
+        visit(best_known_network12);
+    } else {
+        visit(best_known_network16);
+    }
+}
+
+/// Swap `a` and `b` if `b` goes before `a`, without branches for trivially copyable types: SSE min/max for doubles
+/// (a network of 16 doubles takes 40 ns instead of 60 ns with conditional moves), conditional moves otherwise
+/// (faster than `minss` for floats, 23 ns instead of 35 ns, and scalar `pminsd` would not beat them for integers)
+template <typename T, typename Compare>
+[[maybe_unused]] static inline void compare_exchange(T &a, T &b, const Compare &compare) {
+    constexpr bool less = std::is_same<Compare, std::less<>>::value or std::is_same<Compare, std::less<T>>::value;
+#if defined(__SSE2__)
+    if constexpr (less and std::is_same<T, double>::value) {
+        // `minsd` and `maxsd` return their second operand for equal or unordered ones (-0.0 and 0.0, NaN), so `a`
+        // stays first unless `b < a`; in assembly, as compilers fold the intrinsics into a `min` of either operand
+        double low = b, high = a;
+#if defined(__AVX__)
+        asm("vminsd %2, %1, %0" : "=x"(low) : "x"(b), "x"(a));
+        asm("vmaxsd %2, %1, %0" : "=x"(high) : "x"(a), "x"(b));
+#else
+        asm("minsd %1, %0" : "+x"(low) : "x"(a));
+        asm("maxsd %1, %0" : "+x"(high) : "x"(b));
+#endif
+        a = low, b = high;
+        return;
+    }
+#endif
+    if constexpr (std::is_trivially_copyable<T>::value) {
+        // Conditional moves
+        bool swap = compare(b, a);
+        T low = swap ? b : a;
+        b = swap ? a : b;
+        a = low;
+    } else if (compare(b, a)) {
+        std::swap(a, b);
+    }
+}
+
+/// A sorting network for `n` (at most 16) items, the comparators are generated and unrolled at compile time
+template <size_t n>
+class [[maybe_unused]] SortingNetwork {
+private:
+    static_assert(n <= 16, "SortingNetwork supports at most 16 items");
+
+    static constexpr size_t count() {
+        size_t count = 0;
+        visit_sorting_network(n, [&count](size_t, size_t) {
+            ++ count;
+        });
+        return count;
+    }
+
+public:
+    /// Number of comparators
+    static constexpr size_t size = count();
+
+private:
+    static constexpr std::array<Comparator, size> generate() {
+        std::array<Comparator, size> comparators{};
+        size_t index = 0;
+        visit_sorting_network(n, [&comparators, &index](size_t i, size_t j) {
+            comparators[index ++] = {static_cast<uint8_t>(i), static_cast<uint8_t>(j)};
+        });
+        return comparators;
+    }
+
+    template <typename T, typename Compare, size_t... indexes>
+    static inline void apply([[maybe_unused]] T *items, const Compare &compare, std::index_sequence<indexes...>) {
+        (compare_exchange(items[comparators[indexes].i], items[comparators[indexes].j], compare), ...);
+    }
+
+public:
+    /// The comparators in order
+    static constexpr std::array<Comparator, size> comparators = generate();
+
+    /// Sort `n` items in place
+    template <typename T, typename Compare = std::less<>>
+    [[maybe_unused]] static void sort(T *items, const Compare &compare = Compare()) {
+        apply(items, compare, std::make_index_sequence<size>());
+    }
+};
+
+/// Insertion sort by conditional moves (`items[j] = max(items[j - 1], min(items[j], x))`), for small trivially copyable items
+template <typename T, typename Compare = std::less<>>
+[[maybe_unused]] static inline void branchless_insertion_sort(T *items, size_t n, const Compare &compare = Compare()) {
+    static_assert(std::is_trivially_copyable<T>::value, "Branchless insertion sort needs trivially copyable items");
+    for (size_t i = 1; i < n; ++ i) {
+        T x = items[i];
+        for (size_t j = i; j > 0; -- j) {
+            T low = compare(x, items[j]) ? x : items[j];
+            items[j] = compare(low, items[j - 1]) ? items[j - 1] : low;
+        }
+        items[0] = compare(x, items[0]) ? x : items[0];
+    }
+}
+
+/// Sort `size` (at most 16) items by the sorting network of the runtime size
+template <typename T, typename Compare, size_t... n>
+[[maybe_unused]] static inline void sort_by_network(T *items, size_t size, const Compare &compare, std::index_sequence<n...>) {
+    typedef void (*network_t)(T*, const Compare&);
+    static constexpr network_t networks[] = {&SortingNetwork<n>::template sort<T, Compare>...};
+    networks[size](items, compare);
+}
+
+/// The key of a record which is the record itself
+struct [[maybe_unused]] IdentityKey {
+    template <typename T>
+    [[maybe_unused]] constexpr const T &operator ()(const T &item) const {
+        return item;
+    }
+};
+
+/// LSD radix sort of `n` items by an integer key (8-bit digits, digits shared by all the keys are skipped),
+/// `scratch` must hold `n` items
+template <typename T, typename KeyFunction = IdentityKey>
+[[maybe_unused]] static inline void radix_sort(T *items, T *scratch, size_t n, const KeyFunction &key = KeyFunction()) {
+    typedef typename std::decay<decltype(key(*items))>::type key_t;
+    static_assert(std::is_integral<key_t>::value, "Radix sort needs integer keys");
+    typedef typename std::make_unsigned<key_t>::type digits_t;
+    constexpr size_t digits_count = sizeof(key_t);
+    // Flip the sign bit of signed keys to keep the order
+    constexpr digits_t flip = std::is_signed<key_t>::value ? static_cast<digits_t>(digits_t(1) << (digits_count * 8 - 1)) : 0;
+
+    std::vector<std::array<size_t, 256>> counts(digits_count);
+    for (size_t i = 0; i < n; ++ i) {
+        auto digits = static_cast<digits_t>(static_cast<digits_t>(key(items[i])) ^ flip);
+        for (size_t d = 0; d < digits_count; ++ d) {
+            ++ counts[d][(digits >> (d * 8)) & 0xffu];
+        }
+    }
+    T *source = items, *destination = scratch;
+    for (size_t d = 0; d < digits_count; ++ d) {
+        auto &count = counts[d];
+        if (std::any_of(count.begin(), count.end(), [n](size_t c) { return c == n; })) {
+            continue;
+        }
+        size_t offset = 0;
+        for (auto &c: count) {
+            offset += c, c = offset - c;
+        }
+        for (size_t i = 0; i < n; ++ i) {
+            auto digits = static_cast<digits_t>(static_cast<digits_t>(key(source[i])) ^ flip);
+            destination[count[(digits >> (d * 8)) & 0xffu] ++] = source[i];
+        }
+        std::swap(source, destination);
+    }
+    if (source != items) {
+        std::copy(source, source + n, items);
+    }
+}
+
+/// Sort [`begin`, `end`), small arrays go to sorting networks (up to 16) or branchless insertion sort (up to 32)
+template <typename T, typename Compare = std::less<>>
+[[maybe_unused]] void sort(T *begin, T *end, const Compare &compare = Compare()) {
+    auto size = static_cast<size_t>(end - begin);
+    if (size <= 16) {
+        sort_by_network(begin, size, compare, std::make_index_sequence<17>());
+    } else if constexpr (std::is_trivially_copyable<T>::value) {
+        if (size <= 32) {
+            branchless_insertion_sort(begin, size, compare);
+        } else {
+            std::sort(begin, end, compare);
+        }
+    } else {
+        std::sort(begin, end, compare);
+    }
+}
+
+/// Sort `n` items, the small-size kernel is selected at compile time
+template <size_t n, typename T, typename Compare = std::less<>>
+[[maybe_unused]] void sort(T *items, const Compare &compare = Compare()) {
+    if constexpr (n <= 16) {
+        SortingNetwork<n>::sort(items, compare);
+    } else if constexpr (n <= 32 and std::is_trivially_copyable<T>::value) {
+        branchless_insertion_sort(items, n, compare);
+    } else {
+        std::sort(items, items + n, compare);
+    }
+}
+
+/// Sort a `std::array`, the small-size kernel is selected at compile time
+template <typename T, size_t n, typename Compare = std::less<>>
+[[maybe_unused]] void sort(std::array<T, n> &array, const Compare &compare = Compare()) {
+    sort<n>(array.data(), compare);
+}
+
+/// Whether the iterators of a range are declared random-access
+template <typename Range, typename = void>
+struct [[maybe_unused]] is_random_access_range: std::false_type {};
+
+template <typename Range>
+struct [[maybe_unused]] is_random_access_range<Range, std::void_t<typename std::iterator_traits<
+        decltype(std::declval<Range&>().begin())>::iterator_category>>: std::is_base_of<std::random_access_iterator_tag,
+        typename std::iterator_traits<decltype(std::declval<Range&>().begin())>::iterator_category> {};
+
+/// Sort a range (contiguous ranges take the small-size fast path, other than random-access ones are sorted in a copy)
+template <typename Range, typename Compare = std::less<>, typename = decltype(std::declval<Range&>().begin())>
+[[maybe_unused]] void sort(Range &range, const Compare &compare = Compare()) {
+    if constexpr (is_contiguous_range<Range, typename Range::value_type>::value) {
+        sort(range.data(), range.data() + (range.end() - range.begin()), compare);
+    } else if constexpr (is_random_access_range<Range>::value) {
+        std::sort(range.begin(), range.end(), compare);
+    } else {
+        std::vector<typename Range::value_type> items(range.begin(), range.end());
+        sort(items.data(), items.data() + items.size(), compare);
+        std::move(items.begin(), items.end(), range.begin());
+    }
+}
+
+} // namespace cherry
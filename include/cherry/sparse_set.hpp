@@ -0,0 +1,270 @@
+/*
+ * Cherry: sparse-dense integer sets with O(1) clear
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+
+#include "bitset.hpp"
+
+namespace cherry {
+
+/// Frees memory from `std::malloc` or `std::calloc`
+struct [[maybe_unused]] FreeDeleter {
+    [[maybe_unused]] void operator ()(void *pointer) const {
+        std::free(pointer);
+    }
+};
+
+/// A Briggs-Torczon sparse set of integers in [0, `universe`): O(1) insertion, erasure, membership and clear,
+/// the items are iterated densely in insertion order (an erasure moves the last item into the hole);
+/// the sparse array comes from `std::calloc`, which maps zero pages lazily for large universes
+template <typename T = uint32_t>
+class [[maybe_unused]] SparseSet {
+private:
+    static_assert(std::is_integral<T>::value and std::is_unsigned<T>::value, "SparseSet holds unsigned integers");
+
+    size_t universe, count = 0;
+    std::unique_ptr<T[], FreeDeleter> dense, sparse;
+
+public:
+    typedef T value_type;
+    typedef const T *iterator;
+    typedef const T *const_iterator;
+    typedef std::reverse_iterator<const T*> reverse_iterator;
+    typedef std::reverse_iterator<const T*> const_reverse_iterator;
+
+    [[maybe_unused]] explicit SparseSet(size_t universe): universe(universe),
+            dense(static_cast<T*>(std::malloc(std::max<size_t>(universe, 1) * sizeof(T)))),
+            sparse(static_cast<T*>(std::calloc(std::max<size_t>(universe, 1), sizeof(T)))) {
+        assert(universe == 0 or universe - 1 <= std::numeric_limits<T>::max());
+    }
+
+    /// The set bits of a `Bitset` (the universe is its size)
+    [[maybe_unused]] explicit SparseSet(const Bitset &bitset): SparseSet(static_cast<size_t>(bitset.size())) {
+        const uint64_t *words = bitset.words();
+        for (size_t i = 0; i * Bitset::width < universe; ++ i) {
+            for (uint64_t word = words[i]; word != 0; word &= word - 1) {
+                insert(static_cast<T>(i * Bitset::width + __builtin_ctzll(word)));
+            }
+        }
+    }
+
+    [[maybe_unused]] SparseSet(const SparseSet &other): SparseSet(other.universe) {
+        for (T item: other) {
+            insert(item);
+        }
+    }
+
+    SparseSet(SparseSet &&other) noexcept = default;
+
+    [[maybe_unused]] [[nodiscard]] bool contains(T item) const {
+        assert(item < universe);
+        T index = sparse[item];
+        return index < count and dense[index] == item;
+    }
+
+    /// Insert an item, return whether it was absent
+    [[maybe_unused]] bool insert(T item) {
+        if (contains(item)) {
+            return false;
+        }
+        sparse[item] = static_cast<T>(count);
+        dense[count ++] = item;
+        return true;
+    }
+
+    /// Erase an item (the last item takes its place), return whether it was present
+    [[maybe_unused]] bool erase(T item) {
+        if (not contains(item)) {
+            return false;
+        }
+        T index = sparse[item], last = dense[-- count];
+        dense[index] = last;
+        sparse[last] = index;
+        return true;
+    }
+
+    /// Remove all the items in O(1)
+    [[maybe_unused]] void clear() {
+        count = 0;
+    }
+
+    [[maybe_unused]] [[nodiscard]] size_t size() const {
+        return count;
+    }
+
+    [[maybe_unused]] [[nodiscard]] bool empty() const {
+        return count == 0;
+    }
+
+    /// The upper bound (exclusive) of the items
+    [[maybe_unused]] [[nodiscard]] size_t capacity() const {
+        return universe;
+    }
+
+    /// The dense items
+    [[maybe_unused]] [[nodiscard]] const T *data() const {
+        return dense.get();
+    }
+
+    [[maybe_unused]] [[nodiscard]] T operator [](size_t index) const {
+        return dense[index];
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator begin() const {
+        return dense.get();
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator end() const {
+        return dense.get() + count;
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+
+    /// Convert to a `Bitset` of the universe in O(size)
+    [[maybe_unused]] [[nodiscard]] Bitset to_bitset() const {
+        Bitset bitset(static_cast<int>(universe));
+        for (T item: *this) {
+            bitset.set_bit(static_cast<int>(item), true);
+        }
+        return bitset;
+    }
+};
+
+/// A sparse set whose slots carry the generation of their items: membership is one load (no dependent load of
+/// the dense array), and clear only bumps the generation (the slots are reset once every 2^32 clears)
+class [[maybe_unused]] GenerationSparseSet {
+private:
+    struct Slot {
+        uint32_t generation, index;
+    };
+
+    size_t universe, count = 0;
+    uint32_t generation = 1;
+    std::unique_ptr<uint32_t[], FreeDeleter> dense;
+    std::unique_ptr<Slot[], FreeDeleter> slots;
+
+public:
+    typedef uint32_t value_type;
+    typedef const uint32_t *iterator;
+    typedef const uint32_t *const_iterator;
+    typedef std::reverse_iterator<const uint32_t*> reverse_iterator;
+    typedef std::reverse_iterator<const uint32_t*> const_reverse_iterator;
+
+    [[maybe_unused]] explicit GenerationSparseSet(size_t universe): universe(universe),
+            dense(static_cast<uint32_t*>(std::malloc(std::max<size_t>(universe, 1) * sizeof(uint32_t)))),
+            slots(static_cast<Slot*>(std::calloc(std::max<size_t>(universe, 1), sizeof(Slot)))) {}
+
+    /// The set bits of a `Bitset` (the universe is its size)
+    [[maybe_unused]] explicit GenerationSparseSet(const Bitset &bitset):
+            GenerationSparseSet(static_cast<size_t>(bitset.size())) {
+        const uint64_t *words = bitset.words();
+        for (size_t i = 0; i * Bitset::width < universe; ++ i) {
+            for (uint64_t word = words[i]; word != 0; word &= word - 1) {
+                insert(static_cast<uint32_t>(i * Bitset::width + __builtin_ctzll(word)));
+            }
+        }
+    }
+
+    [[maybe_unused]] [[nodiscard]] bool contains(uint32_t item) const {
+        assert(item < universe);
+        return slots[item].generation == generation;
+    }
+
+    /// Insert an item, return whether it was absent
+    [[maybe_unused]] bool insert(uint32_t item) {
+        if (contains(item)) {
+            return false;
+        }
+        slots[item] = {generation, static_cast<uint32_t>(count)};
+        dense[count ++] = item;
+        return true;
+    }
+
+    /// Erase an item (the last item takes its place), return whether it was present
+    [[maybe_unused]] bool erase(uint32_t item) {
+        if (not contains(item)) {
+            return false;
+        }
+        uint32_t index = slots[item].index, last = dense[-- count];
+        dense[index] = last;
+        slots[last].index = index;
+        slots[item].generation = 0;
+        return true;
+    }
+
+    /// Remove all the items in O(1) (amortized)
+    [[maybe_unused]] void clear() {
+        count = 0;
+        if (++ generation == 0) {
+            std::memset(slots.get(), 0, universe * sizeof(Slot));
+            generation = 1;
+        }
+    }
+
+    [[maybe_unused]] [[nodiscard]] size_t size() const {
+        return count;
+    }
+
+    [[maybe_unused]] [[nodiscard]] bool empty() const {
+        return count == 0;
+    }
+
+    /// The upper bound (exclusive) of the items
+    [[maybe_unused]] [[nodiscard]] size_t capacity() const {
+        return universe;
+    }
+
+    /// The dense items
+    [[maybe_unused]] [[nodiscard]] const uint32_t *data() const {
+        return dense.get();
+    }
+
+    [[maybe_unused]] [[nodiscard]] uint32_t operator [](size_t index) const {
+        return dense[index];
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator begin() const {
+        return dense.get();
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator end() const {
+        return dense.get() + count;
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+
+    /// Convert to a `Bitset` of the universe in O(size)
+    [[maybe_unused]] [[nodiscard]] Bitset to_bitset() const {
+        Bitset bitset(static_cast<int>(universe));
+        for (uint32_t item: *this) {
+            bitset.set_bit(static_cast<int>(item), true);
+        }
+        return bitset;
+    }
+};
+
+} // namespace cherry
@@ -0,0 +1,295 @@
+/*
+ * Cherry: strided multi-dimensional views
+ */
+
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+
+#include "ranges.hpp"
+#include "units.hpp"
+
+namespace cherry {
+
+/// Memory layouts of `StridedView`
+enum class [[maybe_unused]] Layout {
+    right, // Row-major, the last dimension is contiguous
+    left   // Column-major, the first dimension is contiguous
+};
+
+/// A rank-N strided view over contiguous storage (mdspan-style), strides are in items
+template <typename T, size_t rank>
+class [[maybe_unused]] StridedView {
+private:
+    static_assert(rank > 0, "The rank of StridedView must be positive");
+
+    typedef std::array<size_t, rank> shape_t;
+
+    T *pointer;
+    shape_t extents{}, strides{};
+
+public:
+    [[maybe_unused]] typedef typename std::remove_cv<T>::type value_type;
+
+    /// Items in a row-major order of the logical indexes
+    struct [[maybe_unused]] Iterator {
+        typedef std::forward_iterator_tag iterator_category;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::remove_cv<T>::type value_type;
+        typedef T* pointer;
+        typedef T& reference;
+
+        T *item;
+        const StridedView *view;
+        shape_t index{};
+        size_t remaining;
+
+        [[maybe_unused]] Iterator(const StridedView *view, size_t remaining):
+                item(view->pointer), view(view), remaining(remaining) {}
+
+        [[maybe_unused]] T &operator *() const {
+            return *item;
+        }
+
+        [[maybe_unused]] Iterator operator ++() {
+            -- remaining;
+            for (size_t d = rank; d-- > 0; ) {
+                item += view->strides[d];
+                if (++ index[d] < view->extents[d] or d == 0) {
+                    break;
+                }
+                item -= view->strides[d] * index[d];
+                index[d] = 0;
+            }
+            return *this;
+        }
+
+        [[maybe_unused]] bool operator ==(const Iterator &other) const {
+            return remaining == other.remaining;
+        }
+
+        [[maybe_unused]] bool operator !=(const Iterator &other) const {
+            return remaining != other.remaining;
+        }
+    };
+
+    typedef Iterator iterator;
+    typedef Iterator const_iterator;
+
+    /// A view with explicit strides (the `strided` layout)
+    [[maybe_unused]] StridedView(T *pointer, const shape_t &extents, const shape_t &strides):
+            pointer(pointer), extents(extents), strides(strides) {}
+
+    /// A view with a `right` (row-major) or `left` (column-major) layout
+    [[maybe_unused]] StridedView(T *pointer, const shape_t &extents, Layout layout=Layout::right):
+            pointer(pointer), extents(extents) {
+        size_t stride = 1;
+        for (size_t i = 0; i < rank; ++ i) {
+            size_t d = layout == Layout::right ? rank - 1 - i : i;
+            strides[d] = stride;
+            stride *= extents[d];
+        }
+    }
+
+    /// Access an item by indexes
+    template <typename... Indexes>
+    [[maybe_unused]] T &operator ()(Indexes... indexes) const {
+        static_assert(sizeof...(Indexes) == rank, "The number of indexes must be the rank");
+        shape_t index = {static_cast<size_t>(indexes)...};
+        size_t offset = 0;
+        for (size_t d = 0; d < rank; ++ d) {
+            assert(index[d] < extents[d]);
+            offset += index[d] * strides[d];
+        }
+        return pointer[offset];
+    }
+
+    /// The item at index zero (not named `data`, the items are not contiguous in general)
+    [[maybe_unused]] [[nodiscard]] T *base() const {
+        return pointer;
+    }
+
+    [[maybe_unused]] [[nodiscard]] size_t extent(size_t d) const {
+        return extents[d];
+    }
+
+    [[maybe_unused]] [[nodiscard]] size_t stride(size_t d) const {
+        return strides[d];
+    }
+
+    /// Number of items
+    [[maybe_unused]] [[nodiscard]] size_t size() const {
+        size_t count = 1;
+        for (const auto &extent: extents) {
+            count *= extent;
+        }
+        return count;
+    }
+
+    /// Whether the items are contiguous in the row-major order
+    [[maybe_unused]] [[nodiscard]] bool is_contiguous() const {
+        size_t stride = 1;
+        for (size_t d = rank; d-- > 0; ) {
+            if (extents[d] != 1 and strides[d] != stride) {
+                return false;
+            }
+            stride *= extents[d];
+        }
+        return true;
+    }
+
+    /// Fix the dimension `d` at `index`, return a view of rank - 1
+    [[maybe_unused]] [[nodiscard]] StridedView<T, rank - 1> slice(size_t d, size_t index) const {
+        static_assert(rank > 1, "A rank-1 view can not be sliced");
+        assert(d < rank and index < extents[d]);
+        std::array<size_t, rank - 1> sliced_extents{}, sliced_strides{};
+        for (size_t i = 0, j = 0; i < rank; ++ i) {
+            if (i != d) {
+                sliced_extents[j] = extents[i], sliced_strides[j] = strides[i], ++ j;
+            }
+        }
+        return StridedView<T, rank - 1>(pointer + index * strides[d], sliced_extents, sliced_strides);
+    }
+
+    /// Permute the dimensions (only strides change), the `d`-th dimension of the result is `permutation[d]` of this
+    [[maybe_unused]] [[nodiscard]] StridedView transpose(const shape_t &permutation) const {
+        shape_t permuted_extents{}, permuted_strides{};
+        for (size_t d = 0; d < rank; ++ d) {
+            assert(permutation[d] < rank);
+            permuted_extents[d] = extents[permutation[d]], permuted_strides[d] = strides[permutation[d]];
+        }
+        return StridedView(pointer, permuted_extents, permuted_strides);
+    }
+
+    /// Reverse the dimensions (the matrix transpose for rank 2)
+    [[maybe_unused]] [[nodiscard]] StridedView transpose() const {
+        shape_t permutation{};
+        for (size_t d = 0; d < rank; ++ d) {
+            permutation[d] = rank - 1 - d;
+        }
+        return transpose(permutation);
+    }
+
+    /// A sub-block starting at `offsets` with `sub_extents`
+    [[maybe_unused]] [[nodiscard]] StridedView subspan(const shape_t &offsets, const shape_t &sub_extents) const {
+        size_t offset = 0;
+        for (size_t d = 0; d < rank; ++ d) {
+            assert(offsets[d] + sub_extents[d] <= extents[d]);
+            offset += offsets[d] * strides[d];
+        }
+        return StridedView(pointer + offset, sub_extents, strides);
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator begin() const {
+        return const_iterator(this, size());
+    }
+
+    [[maybe_unused]] [[nodiscard]] const_iterator end() const {
+        return const_iterator(this, 0);
+    }
+};
+
+/// Return a rank-N view over contiguous storage (`right` or `left` layout)
+template <typename T, size_t rank>
+[[maybe_unused]] [[nodiscard]] StridedView<T, rank> strided(T *pointer, const std::array<size_t, rank> &extents,
+                                                             Layout layout=Layout::right) {
+    return StridedView<T, rank>(pointer, extents, layout);
+}
+
+/// Visit all the items as `f(item, index)` in cache-sized tiles over the last two dimensions
+template <typename T, size_t rank, typename Function>
+[[maybe_unused]] void for_each_tile(const StridedView<T, rank> &view, const Function &f, size_t tile_bytes=Unit::KiB(16)) {
+    std::array<size_t, rank> index{};
+    if constexpr (rank == 1) {
+        for (index[0] = 0; index[0] < view.extent(0); ++ index[0]) {
+            f(view.base()[index[0] * view.stride(0)], index);
+        }
+    } else {
+        // A square tile of the last two dimensions fits in `tile_bytes`
+        auto tile = static_cast<size_t>(std::sqrt(static_cast<double>(tile_bytes / sizeof(T))));
+        tile = std::max<size_t>(tile, 1);
+        size_t outer = 1;
+        for (size_t d = 0; d + 2 < rank; ++ d) {
+            outer *= view.extent(d);
+        }
+        for (size_t o = 0; o < outer; ++ o) {
+            // Decompose the outer index
+            size_t rest = o, base = 0;
+            for (size_t d = rank - 2; d-- > 0; ) {
+                index[d] = rest % view.extent(d), rest /= view.extent(d);
+                base += index[d] * view.stride(d);
+            }
+            size_t rows = view.extent(rank - 2), columns = view.extent(rank - 1);
+            size_t row_stride = view.stride(rank - 2), column_stride = view.stride(rank - 1);
+            for (size_t ri = 0; ri < rows; ri += tile) {
+                for (size_t ci = 0; ci < columns; ci += tile) {
+                    size_t row_end = std::min(rows, ri + tile), column_end = std::min(columns, ci + tile);
+                    for (size_t r = ri; r < row_end; ++ r) {
+                        index[rank - 2] = r;
+                        T *row = view.base() + base + r * row_stride;
+                        for (size_t c = ci; c < column_end; ++ c) {
+                            index[rank - 1] = c;
+                            f(row[c * column_stride], index);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// Cache-oblivious out-of-place matrix transpose (`destination(j, i) = source(i, j)`), recursing on the longer side
+template <typename T, typename U>
+[[maybe_unused]] void transpose_copy(const StridedView<T, 2> &source, const StridedView<U, 2> &destination) {
+    assert(source.extent(0) == destination.extent(1) and source.extent(1) == destination.extent(0));
+    constexpr size_t block = 16;
+    size_t rows = source.extent(0), columns = source.extent(1);
+    if (rows <= block and columns <= block) {
+        const T *from = source.base();
+        U *to = destination.base();
+        size_t from_row = source.stride(0), from_column = source.stride(1);
+        size_t to_row = destination.stride(0), to_column = destination.stride(1);
+        for (size_t i = 0; i < rows; ++ i) {
+            for (size_t j = 0; j < columns; ++ j) {
+                to[j * to_row + i * to_column] = from[i * from_row + j * from_column];
+            }
+        }
+    } else if (rows >= columns) {
+        size_t half = rows / 2;
+        transpose_copy(source.subspan({0, 0}, {half, columns}), destination.subspan({0, 0}, {columns, half}));
+        transpose_copy(source.subspan({half, 0}, {rows - half, columns}),
+                       destination.subspan({0, half}, {columns, rows - half}));
+    } else {
+        size_t half = columns / 2;
+        transpose_copy(source.subspan({0, 0}, {rows, half}), destination.subspan({0, 0}, {half, rows}));
+        transpose_copy(source.subspan({0, half}, {rows, columns - half}),
+                       destination.subspan({half, 0}, {columns - half, rows}));
+    }
+}
+
+/// Indexing a contiguous array by a counting range is a strided slice (contiguous if the step is 1)
+template <typename Array, typename T, typename = typename std::enable_if<
+        is_contiguous_range<Array, typename Array::value_type>::value>::type>
+[[maybe_unused]] [[nodiscard]] StridedView<typename Array::value_type, 1> indexing(Array &array, const IotaRange<T> &indexes) {
+    assert(indexes.stride() > 0 and
+           (indexes.size() == 0 or static_cast<size_t>(indexes[indexes.size() - 1]) < array.size()));
+    return StridedView<typename Array::value_type, 1>(array.data() + (indexes.size() ? indexes.front() : 0),
+                                                      {indexes.size()}, {static_cast<size_t>(indexes.stride())});
+}
+
+/// Indexing a contiguous array by a counting range is a strided slice (`array` is const reference)
+template <typename Array, typename T, typename = typename std::enable_if<
+        is_contiguous_range<Array, typename Array::value_type>::value>::type>
+[[maybe_unused]] [[nodiscard]] StridedView<const typename Array::value_type, 1> indexing(const Array &array,
+                                                                                      const IotaRange<T> &indexes) {
+    assert(indexes.stride() > 0 and
+           (indexes.size() == 0 or static_cast<size_t>(indexes[indexes.size() - 1]) < array.size()));
+    return StridedView<const typename Array::value_type, 1>(array.data() + (indexes.size() ? indexes.front() : 0),
+                                                            {indexes.size()}, {static_cast<size_t>(indexes.stride())});
+}
+
+} // namespace cherry
@@ -0,0 +1,225 @@
+/*
+ * Cherry: string interning pools
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cherry {
+
+/// An append-only arena of characters, the stored strings never move
+class [[maybe_unused]] StringArena {
+private:
+    static constexpr size_t block_size = 65536;
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t used = block_size;
+
+public:
+    /// Copy a string into the arena
+    [[maybe_unused]] std::string_view store(std::string_view text) {
+        if (text.empty()) {
+            // No block is needed (there may be none yet)
+            return {};
+        }
+        if (text.size() > block_size / 4) {
+            // Large strings get their own block, the current block stays at the back
+            std::unique_ptr<char[]> block(new char[text.size()]);
+            char *address = block.get();
+            std::memcpy(address, text.data(), text.size());
+            blocks.insert(blocks.empty() ? blocks.end() : blocks.end() - 1, std::move(block));
+            return {address, text.size()};
+        }
+        if (used + text.size() > block_size) {
+            blocks.emplace_back(new char[block_size]);
+            used = 0;
+        }
+        char *address = blocks.back().get() + used;
+        std::memcpy(address, text.data(), text.size());
+        used += text.size();
+        return {address, text.size()};
+    }
+};
+
+/// An open-addressing hash table from strings to ids (the strings are held outside)
+class [[maybe_unused]] InternTable {
+private:
+    // Higher 32 bits: hash, lower 32 bits: id + 1 (0 for empty)
+    std::vector<uint64_t> slots = std::vector<uint64_t>(16, 0);
+    size_t count = 0;
+
+    void grow() {
+        std::vector<uint64_t> old_slots(slots.size() * 2, 0);
+        std::swap(slots, old_slots);
+        size_t mask = slots.size() - 1;
+        for (const auto &slot: old_slots) {
+            if (slot != 0) {
+                size_t index = (slot >> 32u) & mask;
+                while (slots[index] != 0) {
+                    index = (index + 1) & mask;
+                }
+                slots[index] = slot;
+            }
+        }
+    }
+
+public:
+    /// Find the id of `text`, or insert `new_id()` if absent, `view_of(id)` returns the string of an id
+    template <typename ViewOf, typename NewId>
+    [[maybe_unused]] uint32_t find_or_insert(uint64_t hash, std::string_view text, const ViewOf &view_of,
+                                             const NewId &new_id) {
+        if ((count + 1) * 4 > slots.size() * 3) {
+            grow();
+        }
+        auto tag = static_cast<uint32_t>(hash);
+        size_t mask = slots.size() - 1, index = tag & mask;
+        while (slots[index] != 0) {
+            if ((slots[index] >> 32u) == tag) {
+                auto id = static_cast<uint32_t>(slots[index] - 1);
+                if (view_of(id) == text) {
+                    return id;
+                }
+            }
+            index = (index + 1) & mask;
+        }
+        uint32_t id = new_id();
+        slots[index] = (static_cast<uint64_t>(tag) << 32u) | (static_cast<uint64_t>(id) + 1);
+        ++ count;
+        return id;
+    }
+
+    /// Find the id of `text`, return whether found
+    template <typename ViewOf>
+    [[maybe_unused]] bool find(uint64_t hash, std::string_view text, const ViewOf &view_of, uint32_t &id) const {
+        auto tag = static_cast<uint32_t>(hash);
+        size_t mask = slots.size() - 1, index = tag & mask;
+        while (slots[index] != 0) {
+            if ((slots[index] >> 32u) == tag and view_of(static_cast<uint32_t>(slots[index] - 1)) == text) {
+                id = static_cast<uint32_t>(slots[index] - 1);
+                return true;
+            }
+            index = (index + 1) & mask;
+        }
+        return false;
+    }
+};
+
+/// A string interning pool, unique strings are stored contiguously in an arena and mapped to dense `uint32_t` ids
+class [[maybe_unused]] StringPool {
+private:
+    StringArena arena;
+    InternTable table;
+    std::vector<std::string_view> views;
+
+public:
+    /// Return the id of `text` (inserted if absent)
+    [[maybe_unused]] uint32_t intern(std::string_view text) {
+        auto view_of = [this](uint32_t id) -> std::string_view {
+            return views[id];
+        };
+        return table.find_or_insert(std::hash<std::string_view>()(text), text, view_of, [&]() -> uint32_t {
+            views.push_back(arena.store(text));
+            return static_cast<uint32_t>(views.size() - 1);
+        });
+    }
+
+    /// Look up the id of `text` without inserting, return whether found
+    [[maybe_unused]] bool lookup(std::string_view text, uint32_t &id) const {
+        return table.find(std::hash<std::string_view>()(text), text, [this](uint32_t id) -> std::string_view {
+            return views[id];
+        }, id);
+    }
+
+    /// The string of an id (zero-copy, valid as long as the pool)
+    [[maybe_unused]] [[nodiscard]] std::string_view view(uint32_t id) const {
+        assert(id < views.size());
+        return views[id];
+    }
+
+    /// Number of unique strings
+    [[maybe_unused]] [[nodiscard]] size_t size() const {
+        return views.size();
+    }
+};
+
+/// A thread-safe string interning pool with sharded tables, `view(id)` is lock-free
+class [[maybe_unused]] ConcurrentStringPool {
+private:
+    static constexpr int shards = 64;
+    static constexpr int segment_bits = 16;
+    static constexpr int max_segments = 65536;
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        StringArena arena;
+        InternTable table;
+    };
+
+    Shard tables[shards];
+    std::atomic<uint32_t> count{0};
+    // Views are stored in lazily allocated segments, so that they never move
+    std::unique_ptr<std::atomic<std::string_view*>[]> segments;
+
+    [[nodiscard]] std::string_view *segment(uint32_t index) {
+        std::string_view *pointer = segments[index].load(std::memory_order_acquire);
+        if (pointer == nullptr) {
+            auto allocated = new std::string_view[1u << segment_bits];
+            if (segments[index].compare_exchange_strong(pointer, allocated, std::memory_order_acq_rel)) {
+                pointer = allocated;
+            } else {
+                delete[] allocated;
+            }
+        }
+        return pointer;
+    }
+
+public:
+    [[maybe_unused]] ConcurrentStringPool(): segments(new std::atomic<std::string_view*>[max_segments]) {
+        for (int i = 0; i < max_segments; ++ i) {
+            segments[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    [[maybe_unused]] ~ConcurrentStringPool() {
+        for (int i = 0; i < max_segments; ++ i) {
+            delete[] segments[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    /// Return the id of `text` (inserted if absent)
+    [[maybe_unused]] uint32_t intern(std::string_view text) {
+        uint64_t hash = std::hash<std::string_view>()(text);
+        // Higher bits choose the shard, lower bits are used in the table
+        Shard &shard = tables[(hash >> 40u) % shards];
+        std::lock_guard<std::mutex> guard(shard.mutex);
+        return shard.table.find_or_insert(hash, text, [this](uint32_t id) -> std::string_view {
+            return view(id);
+        }, [&]() -> uint32_t {
+            uint32_t id = count.fetch_add(1, std::memory_order_relaxed);
+            segment(id >> segment_bits)[id & ((1u << segment_bits) - 1)] = shard.arena.store(text);
+            return id;
+        });
+    }
+
+    /// The string of an id (zero-copy, the id must come from `intern`)
+    [[maybe_unused]] [[nodiscard]] std::string_view view(uint32_t id) const {
+        return segments[id >> segment_bits].load(std::memory_order_acquire)[id & ((1u << segment_bits) - 1)];
+    }
+
+    /// Number of unique strings
+    [[maybe_unused]] [[nodiscard]] size_t size() const {
+        return count.load(std::memory_order_relaxed);
+    }
+};
+
+} // namespace cherry
@@ -0,0 +1,265 @@
+/*
+ * Cherry: spin-then-futex thread synchronization (latch, barrier, event and semaphore)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace cherry {
+
+/// Rounds of `cpu_relax` before a waiting thread parks
+static constexpr size_t spin_count = 1024;
+
+/// Rounds to spin on this machine (none on a single CPU, where spinning only delays the thread to wait for)
+[[maybe_unused]] static inline size_t spin_rounds() {
+    static const size_t rounds = std::thread::hardware_concurrency() > 1 ? spin_count : 0;
+    return rounds;
+}
+
+/// Hint the CPU that this is a spin-wait loop
+[[maybe_unused]] static inline void cpu_relax() {
+#if defined(__SSE2__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+/// Park until `word` may differ from `expected` (spurious wake-ups are possible),
+/// other platforms than Linux only yield
+[[maybe_unused]] static inline void futex_wait(std::atomic<uint32_t> &word, uint32_t expected) {
+#if defined(__linux__)
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Futex needs a plain 32-bit word");
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+    (void) word, (void) expected;
+    std::this_thread::yield();
+#endif
+}
+
+/// Wake at most `count` threads parked on `word`
+[[maybe_unused]] static inline void futex_wake(std::atomic<uint32_t> &word, int count=INT_MAX) {
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#else
+    (void) word, (void) count;
+#endif
+}
+
+/// A futex word with a count of parked threads, so that wakers skip the system call when nobody is parked
+class [[maybe_unused]] FutexWord {
+private:
+    std::atomic<uint32_t> waiters = 0;
+
+public:
+    std::atomic<uint32_t> value;
+
+    [[maybe_unused]] explicit FutexWord(uint32_t value=0): value(value) {}
+
+    /// Wait until `done(value)`, spinning first and then parking, return the value satisfying it
+    template <typename Predicate>
+    [[maybe_unused]] uint32_t wait_until(const Predicate &done) {
+        uint32_t current;
+        for (size_t i = 0, rounds = spin_rounds(); i < rounds; ++ i) {
+            if (done(current = value.load(std::memory_order_acquire))) {
+                return current;
+            }
+            cpu_relax();
+        }
+        // Sequentially consistent with `wake`: either the waker sees the waiter, or the waiter sees the new value
+        waiters.fetch_add(1);
+        while (not done(current = value.load())) {
+            futex_wait(value, current);
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return current;
+    }
+
+    /// Wake at most `count` parked threads after changing the value
+    [[maybe_unused]] void wake(int count=INT_MAX) {
+        if (waiters.load() > 0) {
+            futex_wake(value, count);
+        }
+    }
+};
+
+/// A single-use countdown latch
+class [[maybe_unused]] Latch {
+private:
+    FutexWord remaining;
+
+public:
+    [[maybe_unused]] explicit Latch(uint32_t count): remaining(count) {}
+
+    Latch(const Latch &) = delete;
+
+    Latch &operator =(const Latch &) = delete;
+
+    /// Decrease the count by `n` without waiting
+    [[maybe_unused]] void count_down(uint32_t n=1) {
+        if (remaining.value.fetch_sub(n) == n) {
+            remaining.wake();
+        }
+    }
+
+    /// Whether the count reached zero
+    [[maybe_unused]] [[nodiscard]] bool try_wait() const {
+        return remaining.value.load(std::memory_order_acquire) == 0;
+    }
+
+    /// Wait until the count reaches zero
+    [[maybe_unused]] void wait() {
+        remaining.wait_until([](uint32_t value) {
+            return value == 0;
+        });
+    }
+
+    /// Decrease the count by `n` and wait until it reaches zero
+    [[maybe_unused]] void arrive_and_wait(uint32_t n=1) {
+        count_down(n);
+        wait();
+    }
+};
+
+/// The completion of a `Barrier` phase doing nothing
+struct [[maybe_unused]] NoCompletion {
+    [[maybe_unused]] void operator ()() const {}
+};
+
+/// A reusable sense-reversing barrier for `count` threads, the last arriving thread runs `completion()` before
+/// releasing the others (the sense is a phase counter, which the parked threads wait on)
+template <typename Completion = NoCompletion>
+class [[maybe_unused]] Barrier {
+private:
+    uint32_t count;
+    std::atomic<uint32_t> remaining;
+    FutexWord phase;
+    Completion completion;
+
+public:
+    [[maybe_unused]] explicit Barrier(uint32_t count, Completion completion=Completion()):
+            count(count), remaining(count), completion(std::move(completion)) {}
+
+    Barrier(const Barrier &) = delete;
+
+    Barrier &operator =(const Barrier &) = delete;
+
+    /// Arrive and wait for the other threads of the phase, return `true` in the thread which ran the completion
+    [[maybe_unused]] bool arrive_and_wait() {
+        uint32_t sense = phase.value.load(std::memory_order_acquire);
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            completion();
+            remaining.store(count, std::memory_order_relaxed);
+            phase.value.store(sense + 1);
+            phase.wake();
+            return true;
+        }
+        phase.wait_until([sense](uint32_t value) {
+            return value != sense;
+        });
+        return false;
+    }
+
+    /// Number of completed phases
+    [[maybe_unused]] [[nodiscard]] uint32_t phases() const {
+        return phase.value.load(std::memory_order_acquire);
+    }
+};
+
+/// A manual-reset event
+class [[maybe_unused]] Event {
+private:
+    FutexWord state;
+
+public:
+    [[maybe_unused]] explicit Event(bool set=false): state(set) {}
+
+    Event(const Event &) = delete;
+
+    Event &operator =(const Event &) = delete;
+
+    /// Set and release all the waiting threads
+    [[maybe_unused]] void set() {
+        if (state.value.exchange(1) == 0) {
+            state.wake();
+        }
+    }
+
+    /// Reset, so that later `wait` blocks again
+    [[maybe_unused]] void reset() {
+        state.value.store(0, std::memory_order_release);
+    }
+
+    [[maybe_unused]] [[nodiscard]] bool is_set() const {
+        return state.value.load(std::memory_order_acquire) != 0;
+    }
+
+    /// Wait until set
+    [[maybe_unused]] void wait() {
+        state.wait_until([](uint32_t value) {
+            return value != 0;
+        });
+    }
+};
+
+/// A counting semaphore
+class [[maybe_unused]] Semaphore {
+private:
+    FutexWord available;
+
+public:
+    [[maybe_unused]] explicit Semaphore(uint32_t count=0): available(count) {}
+
+    Semaphore(const Semaphore &) = delete;
+
+    Semaphore &operator =(const Semaphore &) = delete;
+
+    /// Take one if available without waiting
+    [[maybe_unused]] bool try_acquire() {
+        uint32_t current = available.value.load(std::memory_order_relaxed);
+        while (current > 0) {
+            if (available.value.compare_exchange_weak(current, current - 1, std::memory_order_acquire)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Take one, wait if none is available
+    [[maybe_unused]] void acquire() {
+        while (not try_acquire()) {
+            available.wait_until([](uint32_t value) {
+                return value > 0;
+            });
+        }
+    }
+
+    /// Put `n` back and wake as many waiting threads
+    [[maybe_unused]] void release(uint32_t n=1) {
+        available.value.fetch_add(n);
+        available.wake(static_cast<int>(n));
+    }
+
+    /// Currently available count
+    [[maybe_unused]] [[nodiscard]] uint32_t count() const {
+        return available.value.load(std::memory_order_relaxed);
+    }
+};
+
+} // namespace cherry
@@ -0,0 +1,33 @@
+/*
+ * Cherry: nanosecond timer
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace cherry {
+
+/// A nanosecond-level timer
+class [[maybe_unused]] NanoTimer {
+private:
+    typedef std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> time_point_t;
+
+    time_point_t last_time_point;
+
+public:
+    [[maybe_unused]] NanoTimer() {
+        last_time_point = std::chrono::system_clock::now();
+    }
+
+    /// Return the duration from last time point (constructor `Timer()` or `tik()`)
+    [[maybe_unused]] inline uint64_t tik() {
+        time_point_t time_point = std::chrono::system_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(time_point - last_time_point);
+        last_time_point = time_point;
+        return duration.count();
+    }
+};
+
+} // namespace cherry
@@ -0,0 +1,84 @@
+/*
+ * Cherry: size and time units
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace cherry {
+
+/// Numbers
+class [[maybe_unused]] Number {
+public:
+    [[maybe_unused]] static constexpr const double reasonable_infinity = 1e10;
+};
+
+/// Size and time units' helper
+class [[maybe_unused]] Unit {
+public:
+    template<typename T>
+    [[maybe_unused]] [[nodiscard]] static constexpr size_t B(T size) {
+        return size;
+    }
+
+    template<typename T>
+    [[maybe_unused]] [[nodiscard]] static constexpr size_t KiB(T size) {
+        return size * 1024ull;
+    }
+
+    template<typename T>
+    [[maybe_unused]] [[nodiscard]] static constexpr size_t MiB(T size) {
+        return size * 1024ull * 1024ull;
+    }
+
+    template<typename T>
+    [[maybe_unused]] [[nodiscard]] static constexpr size_t GiB(T size) {
+        return size * 1024ull * 1024ull * 1024ull;
+    }
+
+    template<typename T>
+    [[maybe_unused]] [[nodiscard]] static constexpr uint64_t ns(T duration) {
+        return duration;
+    }
+
+    template<typename T>
+    [[maybe_unused]] [[nodiscard]] static constexpr uint64_t us(T duration) {
+        return duration * 1000ull;
+    }
+
+    template<typename T>
+    [[maybe_unused]] [[nodiscard]] static constexpr uint64_t ms(T duration) {
+        return duration * 1000000ull;
+    }
+
+    template<typename T>
+    [[maybe_unused]] [[nodiscard]] static constexpr uint64_t s(T duration) {
+        return duration * 1000000000ull;
+    }
+
+    /// Convert `std::string` to `size_t`
+    [[maybe_unused]] [[nodiscard]] static size_t bytes_from(const std::string &text) {
+        const char *ptr = text.c_str();
+        char *unit_ptr;
+        double size = strtod(ptr, &unit_ptr);
+        if (unit_ptr - ptr == text.size()) {
+            std::fprintf(stderr, "No unit specified\n");
+        } else if (*unit_ptr == 'B') {
+            return B(size);
+        } else if (*unit_ptr == 'K') {
+            return KiB(size);
+        } else if (*unit_ptr == 'M') {
+            return MiB(size);
+        } else if (*unit_ptr == 'G') {
+            return GiB(size);
+        }
+        std::fprintf(stderr, "Failed to parse size (format: {num}{B/KiB/MiB/GiB}, e.g. 8GiB)\n");
+        return 0;
+    }
+};
+
+} // namespace cherry
@@ -1,5 +1,13 @@
 #include <bitset>
 #include <cmath>
+#include <fcntl.h>
+#include <fstream>
+#include <list>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <thread>
 
 #include "cherry.hpp"
 #include "gtest/gtest.h"
@@ -285,9 +293,18 @@ TEST(Cherry, check_duplicate) {
     ASSERT_EQ(cherry::check_duplicate(vec), true);
     ASSERT_EQ(cherry::check_duplicate(cherry::shift(vec, 1)), false);
 
-    // TODO: bug
-    // std::vector<int> vec2 = {1, 2, 3};
-    // ASSERT_EQ(check_duplicate(join(vec, vec2)), true);
+    std::vector<int> vec2 = {1, 2, 3};
+    ASSERT_EQ(cherry::check_duplicate(cherry::join(vec, vec2)), true);
+
+    // Duplicates are equivalent items by `operator <` (no `operator ==` needed)
+    struct Key {
+        int key, payload;
+        bool operator <(const Key &other) const {
+            return key < other.key;
+        }
+    };
+    ASSERT_EQ(cherry::check_duplicate(std::vector<Key>{{1, 1}, {2, 2}, {1, 3}}), true);
+    ASSERT_EQ(cherry::check_duplicate(std::vector<Key>{{1, 1}, {2, 1}}), false);
 }
 
 /// Check `push`
@@ -339,3 +356,1365 @@ TEST(Cherry, pretty_range) {
     ASSERT_EQ(cherry::pretty_range(vec), "[0, 1, 2, 3, 4]");
     ASSERT_EQ(cherry::pretty_range(cherry::reverse(vec)), "[4, 3, 2, 1, 0]");
 }
+
+/// Check `TokenBucket`
+TEST(Cherry, TokenBucket) {
+    // The bucket is full at the beginning, and refills slowly
+    cherry::TokenBucket bucket(1.0, 10);
+    ASSERT_EQ(bucket.capacity(), 10);
+    ASSERT_EQ(bucket.try_acquire(4), true);
+    ASSERT_EQ(bucket.try_acquire(6), true);
+    ASSERT_EQ(bucket.try_acquire(1), false);
+
+    // Concurrent acquiring never exceeds the burst
+    cherry::TokenBucket shared_bucket(1.0, 1000);
+    std::atomic<int> acquired(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++ i) {
+        threads.emplace_back([&]() {
+            for (int j = 0; j < 1000; ++ j) {
+                acquired += shared_bucket.try_acquire();
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    ASSERT_GE(acquired, 1000);
+    ASSERT_LE(acquired, 1010);
+
+    // Fast refilling
+    cherry::TokenBucket fast_bucket(1e6, 100);
+    ASSERT_EQ(fast_bucket.try_acquire(100), true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ASSERT_EQ(fast_bucket.available(), 100);
+}
+
+/// Check `RateMeter`
+TEST(Cherry, RateMeter) {
+    cherry::RateMeter meter;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++ i) {
+        threads.emplace_back([&meter]() {
+            for (int j = 0; j < 1000; ++ j) {
+                meter.mark();
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    ASSERT_EQ(meter.count(), 4000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    ASSERT_GT(meter.rate1(), 0);
+    ASSERT_GT(meter.rate1(), meter.rate15());
+    ASSERT_GT(meter.mean_rate(), 0);
+    ASSERT_EQ(meter.pretty().front(), '[');
+    ASSERT_EQ(cherry::pretty_rate(1500), "1.500 K/s");
+}
+
+/// Check `FlightRecorder`
+TEST(Cherry, FlightRecorder) {
+    // Record more events than the capacity, only the last ones are kept
+    for (uint64_t i = 0; i < cherry::FlightRecorder::capacity + 10; ++ i) {
+        flight_record("event", i, i * 2);
+    }
+    FILE *file = tmpfile();
+    cherry::FlightRecorder::dump(fileno(file), 2);
+    std::rewind(file);
+    char buffer[1024] = {};
+    auto length = fread(buffer, 1, sizeof(buffer) - 1, file);
+    fclose(file);
+    std::string text(buffer, length);
+    ASSERT_NE(text.find("last 2 events"), std::string::npos);
+    ASSERT_NE(text.find("event 4104 8208"), std::string::npos);
+    ASSERT_EQ(text.find("event 4103 8206"), std::string::npos);
+
+    // Dumped by `unreachable()`
+    ASSERT_EXIT({
+        flight_record("before_exit", 42);
+        unreachable();
+    }, ::testing::ExitedWithCode(EXIT_FAILURE), "before_exit 42 0");
+}
+
+/// Check `SamplingProfiler`
+TEST(Cherry, SamplingProfiler) {
+    ASSERT_TRUE(cherry::SamplingProfiler::start(1000));
+    timer_t timer;
+    ASSERT_TRUE(cherry::SamplingProfiler::profile_this_thread(timer));
+    // Burn about 200 ms of CPU time
+    volatile double value = 0;
+    cherry::NanoTimer busy_timer;
+    uint64_t busy = 0;
+    while (busy < cherry::Unit::ms(200)) {
+        for (int i = 0; i < 10000; ++ i) {
+            value = value + std::sqrt(static_cast<double>(i));
+        }
+        busy += busy_timer.tik();
+    }
+    cherry::SamplingProfiler::stop_thread(timer);
+    cherry::SamplingProfiler::stop();
+
+    // About 200 samples, the thread is not sampled by both timers
+    ASSERT_GT(cherry::SamplingProfiler::samples_count(), 0);
+    ASSERT_LT(cherry::SamplingProfiler::samples_count(), 300);
+    auto text = cherry::SamplingProfiler::folded();
+    ASSERT_FALSE(text.empty());
+    ASSERT_EQ(text.back(), '\n');
+    ASSERT_NE(text.find(' '), std::string::npos);
+
+    // An interval of a whole second
+    ASSERT_TRUE(cherry::SamplingProfiler::start(1));
+    cherry::SamplingProfiler::stop();
+}
+
+/// Check `Autotuner` and `TunedKernel`
+TEST(Cherry, Autotuner) {
+    std::string path = "cherry_autotune_test.txt";
+    std::remove(path.c_str());
+
+    int calls = 0;
+    auto slow = [&calls](int64_t, std::vector<int> &) {
+        ++ calls;
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    };
+    auto chunked = [&calls](int64_t chunk, std::vector<int> &) {
+        ++ calls;
+        std::this_thread::sleep_for(std::chrono::microseconds(chunk == 64 ? 10 : 1000));
+    };
+
+    // Calibrate and choose the fastest variant
+    std::vector<int> vec(1000);
+    {
+        cherry::Autotuner tuner(path, 2);
+        cherry::TunedKernel<std::vector<int>&> kernel(tuner, "sleep");
+        kernel.add("slow", slow);
+        kernel.add("chunked", {16, 64, 256}, chunked);
+        auto choice = kernel.select(vec.size(), vec);
+        ASSERT_EQ(kernel.name(choice), "chunked");
+        ASSERT_EQ(choice.param, 64);
+        ASSERT_EQ(calls, 12);
+        kernel(vec.size(), vec);
+        ASSERT_EQ(calls, 13);
+    }
+
+    // Loaded from the cache without calibration
+    {
+        cherry::Autotuner tuner(path, 2);
+        cherry::TunedKernel<std::vector<int>&> kernel(tuner, "sleep");
+        kernel.add("slow", slow);
+        kernel.add("chunked", {16, 64, 256}, chunked);
+        auto choice = kernel.select(1023, vec);
+        ASSERT_EQ(kernel.name(choice), "chunked");
+        ASSERT_EQ(choice.param, 64);
+        ASSERT_EQ(calls, 13);
+    }
+    std::remove(path.c_str());
+}
+
+/// Check `Deadline` and deadline-aware algorithms
+TEST(Cherry, Deadline) {
+    std::vector<int> vec(1000);
+    for (int i = 0; i < 1000; ++ i) {
+        vec[i] = i;
+    }
+
+    // Enough budget
+    cherry::Deadline enough(cherry::Unit::s(10));
+    auto progress = cherry::for_each(vec, [](int &item) { ++ item; }, enough);
+    ASSERT_TRUE(progress.completed);
+    ASSERT_EQ(progress.processed, 1000);
+    ASSERT_EQ(vec[0], 1);
+    auto found = cherry::find(vec, 500, enough);
+    ASSERT_TRUE(found.completed);
+    ASSERT_TRUE(found.value);
+    ASSERT_EQ(found.processed, 500);
+    auto mapped = cherry::map(vec, [](int item) -> int { return item * 2; }, enough);
+    ASSERT_TRUE(mapped.completed);
+    ASSERT_EQ(mapped.value.size(), 1000);
+
+    // Cut off by the budget
+    cherry::Deadline short_deadline(cherry::Unit::ms(5));
+    auto cut = cherry::any_of(vec, [](int) -> bool {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        return false;
+    }, short_deadline);
+    ASSERT_FALSE(cut.completed);
+    ASSERT_FALSE(cut.value);
+    ASSERT_GT(cut.processed, 0);
+    ASSERT_LT(cut.processed, 1000);
+
+    // Cut off by the token
+    cherry::StopToken token;
+    cherry::Deadline stoppable(token);
+    auto stopped = cherry::for_each(vec, [&token](const int &item) {
+        if (item == 10) {
+            token.request_stop();
+        }
+    }, stoppable);
+    // The token is only checked every N iterations
+    ASSERT_FALSE(stopped.completed);
+    ASSERT_GT(stopped.processed, 10);
+    ASSERT_LT(stopped.processed, 1000);
+}
+
+/// Check `parse_numbers` and `MappedFile`
+TEST(Cherry, parse_numbers) {
+    // Integers and real numbers
+    std::vector<int> ints;
+    ASSERT_TRUE(cherry::parse_numbers(std::string("1, 2,3\n-4\t+5 "), ints));
+    ASSERT_EQ(cherry::pretty_range(ints), "[1, 2, 3, -4, 5]");
+    std::vector<double> doubles;
+    ASSERT_TRUE(cherry::parse_numbers(std::string("1.5 -2e3\n0.25"), doubles));
+    ASSERT_EQ(doubles.size(), 3);
+    ASSERT_DOUBLE_EQ(doubles[1], -2000.0);
+
+    // Stops at an invalid token
+    std::string invalid = "1 2 x3 4";
+    std::vector<int> prefix;
+    auto stop = cherry::parse_numbers<int>(invalid.data(), invalid.data() + invalid.size(), prefix);
+    ASSERT_EQ(stop - invalid.data(), 4);
+    ASSERT_EQ(prefix.size(), 2);
+    ASSERT_FALSE(cherry::parse_numbers(std::string("1 +-5"), prefix));
+
+    // Columns
+    std::string rows = "1,10\n2,20\n3,30\n";
+    std::vector<std::vector<int>> columns(2);
+    ASSERT_EQ(cherry::parse_columns<int>(rows.data(), rows.data() + rows.size(), columns), rows.data() + rows.size());
+    ASSERT_EQ(cherry::pretty_range(columns[1]), "[10, 20, 30]");
+
+    // Ragged rows stop at the beginning of the line
+    std::string ragged = "1,10\n2\n3,30\n";
+    std::vector<std::vector<int>> ragged_columns(2);
+    ASSERT_EQ(cherry::parse_columns<int>(ragged.data(), ragged.data() + ragged.size(), ragged_columns) - ragged.data(), 5);
+    ASSERT_EQ(cherry::pretty_range(ragged_columns[0]), "[1]");
+    ragged = "1,10,100\n";
+    ASSERT_EQ(cherry::parse_columns<int>(ragged.data(), ragged.data() + ragged.size(), ragged_columns), ragged.data());
+
+    // Parallel parsing on a mapped file
+    std::string path = "cherry_parse_test.txt";
+    {
+        std::ofstream file(path);
+        for (int i = 0; i < 100000; ++ i) {
+            file << i << (i % 10 == 9 ? "\n" : ",");
+        }
+    }
+    cherry::MappedFile file(path);
+    ASSERT_GT(file.size(), 0);
+    std::vector<int64_t> values;
+    ASSERT_TRUE(cherry::parse_numbers_parallel(file.begin(), file.end(), values, 4));
+    ASSERT_EQ(values.size(), 100000);
+    for (int i = 0; i < 100000; ++ i) {
+        ASSERT_EQ(values[i], i);
+    }
+    std::remove(path.c_str());
+
+    // Only the numbers before the first invalid token are kept (in later parts neither)
+    std::string text;
+    for (int i = 0; i < 100000; ++ i) {
+        text += (i == 40000 or i == 90000 ? "x" : std::to_string(i)) + (i % 10 == 9 ? "\n" : ",  ");
+    }
+    values.clear();
+    ASSERT_FALSE(cherry::parse_numbers_parallel(text.data(), text.data() + text.size(), values, 4));
+    ASSERT_EQ(values.size(), 40000);
+    ASSERT_EQ(values.back(), 39999);
+}
+
+/// Check `split` and `lines`
+TEST(Cherry, split) {
+    ASSERT_EQ(cherry::pretty_range(cherry::split("a,b,,c", ",")), "[a, b, , c]");
+    ASSERT_EQ(cherry::pretty_range(cherry::split("a,b;;c;", ",;", true)), "[a, b, c]");
+    size_t empty_tokens = 0;
+    for (const auto &token: cherry::split("", ",")) {
+        ASSERT_TRUE(token.empty());
+        ++ empty_tokens;
+    }
+    ASSERT_EQ(empty_tokens, 1);
+    ASSERT_EQ(cherry::pretty_range(cherry::split(",", ",")), "[, ]");
+    ASSERT_EQ(cherry::pretty_range(cherry::lines("x\r\ny\n\nz\n")), "[x, y, , z]");
+    ASSERT_EQ(cherry::pretty_range(cherry::lines("")), "[]");
+
+    // Long texts go through the SIMD path
+    std::string text;
+    for (int i = 0; i < 100; ++ i) {
+        text += "token" + std::to_string(i) + (i % 3 == 0 ? "\t" : " ");
+    }
+    int count = 0;
+    cherry::for_each(cherry::split(text, " \t", true), [&count](const std::string_view &token) {
+        ASSERT_EQ(token, "token" + std::to_string(count ++));
+    });
+    ASSERT_EQ(count, 100);
+
+    // Other algorithms
+    auto tokens = cherry::split("1 22 333", " ");
+    ASSERT_TRUE(cherry::find(tokens, "22"));
+    ASSERT_TRUE(cherry::all_of(tokens, [](const std::string_view &token) -> bool {
+        return not token.empty();
+    }));
+    auto lengths = cherry::map(tokens, [](const std::string_view &token) -> size_t {
+        return token.size();
+    });
+    ASSERT_EQ(cherry::sum(lengths), 6);
+
+    // Reverse iteration gives the same tokens backwards
+    ASSERT_EQ(cherry::pretty_range(cherry::reverse(cherry::split("a,b,,c", ","))), "[c, , b, a]");
+    ASSERT_EQ(cherry::pretty_range(cherry::reverse(cherry::lines("x\r\n\ny\n"))), "[y, , x]");
+    std::string long_text = text + ",,;" + std::string(40, 'z') + ";";
+    for (const auto &[input, delimiters]: std::vector<std::pair<std::string, std::string>>{
+            {"", ","}, {",", ","}, {",,a,", ","}, {"a\n\n", "\n"}, {long_text, " \t,;"}, {long_text, "\t"}}) {
+        for (bool skip_empty: {false, true}) {
+            auto range = cherry::split(input, delimiters, skip_empty);
+            std::vector<std::string_view> forward, backward;
+            for (const auto &token: range) {
+                forward.push_back(token);
+            }
+            for (auto it = range.rbegin(); it != range.rend(); ++ it) {
+                backward.push_back(*it);
+            }
+            std::reverse(backward.begin(), backward.end());
+            ASSERT_EQ(forward, backward);
+        }
+    }
+}
+
+/// Check `StringPool` and `ConcurrentStringPool`
+TEST(Cherry, StringPool) {
+    cherry::StringPool pool;
+    ASSERT_EQ(pool.intern("cpu"), 0);
+    ASSERT_EQ(pool.intern("memory"), 1);
+    ASSERT_EQ(pool.intern(std::string("cpu")), 0);
+    ASSERT_EQ(pool.intern(std::string(100000, 'x')), 2);
+    ASSERT_EQ(pool.view(1), "memory");
+    ASSERT_EQ(pool.view(2).size(), 100000);
+    uint32_t id;
+    ASSERT_TRUE(pool.lookup("memory", id));
+    ASSERT_EQ(id, 1);
+    ASSERT_FALSE(pool.lookup("disk", id));
+
+    // Many strings, the views stay valid after growing
+    auto first = pool.view(0);
+    for (int i = 0; i < 100000; ++ i) {
+        ASSERT_EQ(pool.intern("key" + std::to_string(i)), i + 3);
+    }
+    ASSERT_EQ(pool.size(), 100003);
+    ASSERT_EQ(first, "cpu");
+    ASSERT_EQ(pool.view(12345 + 3), "key12345");
+
+    // The empty string, first in a new pool
+    cherry::StringPool empty_first;
+    ASSERT_EQ(empty_first.intern(""), 0);
+    ASSERT_EQ(empty_first.intern("cpu"), 1);
+    ASSERT_EQ(empty_first.intern(std::string()), 0);
+    ASSERT_TRUE(empty_first.view(0).empty());
+
+    // Concurrent interning of overlapping keys gives dense and consistent ids
+    cherry::ConcurrentStringPool concurrent_pool;
+    std::vector<std::vector<uint32_t>> ids(4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++ t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 10000; ++ i) {
+                ids[t].push_back(concurrent_pool.intern("key" + std::to_string(i)));
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    ASSERT_EQ(concurrent_pool.size(), 10000);
+    for (int i = 0; i < 10000; ++ i) {
+        ASSERT_EQ(ids[0][i], ids[3][i]);
+        ASSERT_LT(ids[0][i], 10000);
+        ASSERT_EQ(concurrent_pool.view(ids[0][i]), "key" + std::to_string(i));
+    }
+}
+
+/// Check `ArchiveWriter` and `ArchiveReader`
+TEST(Cherry, Archive) {
+    struct Point {
+        float x, y;
+    };
+    std::vector<int> ints = {1, 2, 3, 4, 5};
+    std::vector<Point> points = {{1, 2}, {3, 4}};
+    std::vector<double> empty;
+    cherry::Bitset bitset(100, {1, 50, 99});
+
+    std::string path = "cherry_archive_test.bin";
+    cherry::ArchiveWriter writer;
+    writer.add(ints);
+    writer.add(points);
+    writer.add(empty);
+    writer.add(bitset);
+    ASSERT_TRUE(writer.write(path));
+
+    cherry::ArchiveReader reader(path);
+    ASSERT_TRUE(reader.valid());
+    ASSERT_EQ(reader.size(), 4);
+    auto ints_view = reader.view<int>(0);
+    ASSERT_EQ(cherry::pretty_range(ints_view), "[1, 2, 3, 4, 5]");
+    ASSERT_EQ(cherry::pretty_range(cherry::reverse(cherry::shift(ints_view, 1, 2))), "[3, 2]");
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(ints_view.data()) % 64, 0);
+    auto points_view = reader.view<Point>(1);
+    ASSERT_EQ(points_view.size(), 2);
+    ASSERT_EQ(points_view[1].y, 4);
+    ASSERT_TRUE(reader.view<double>(2).empty());
+    auto read_bitset = *reader.bitset(3);
+    ASSERT_EQ(read_bitset.size(), 100);
+    ASSERT_TRUE(read_bitset.get_bit(50));
+    ASSERT_FALSE(read_bitset.get_bit(51));
+    ASSERT_EQ(read_bitset.hash(), bitset.hash());
+
+    // Mismatched kinds or item sizes are empty
+    ASSERT_TRUE(reader.view<double>(0).empty());
+    ASSERT_TRUE(reader.view<int>(3).empty());
+    ASSERT_FALSE(reader.bitset(0).has_value());
+    ASSERT_TRUE(reader.view<int>(4).empty());
+
+    // A section size overflowing with its offset, or not matching its count
+    auto corrupt = [&path](uint64_t bytes) {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(sizeof(cherry::ArchiveFormat::Header) + offsetof(cherry::ArchiveFormat::Section, bytes));
+        file.write(reinterpret_cast<const char*>(&bytes), sizeof(bytes));
+    };
+    corrupt(UINT64_MAX - 32);
+    ASSERT_FALSE(cherry::ArchiveReader(path).valid());
+    corrupt(4 * sizeof(int));
+    ASSERT_FALSE(cherry::ArchiveReader(path).valid());
+    corrupt(5 * sizeof(int));
+    ASSERT_TRUE(cherry::ArchiveReader(path).valid());
+
+    // Not an archive
+    {
+        std::ofstream file(path);
+        file << "not an archive, just some text";
+    }
+    ASSERT_FALSE(cherry::ArchiveReader(path).valid());
+    std::remove(path.c_str());
+}
+
+/// Check `Sobol`
+TEST(Cherry, Sobol) {
+    // The well-known first points in 2 dimensions
+    cherry::Sobol<double> sobol(2);
+    std::vector<std::vector<double>> expected = {{0, 0}, {0.5, 0.5}, {0.75, 0.25}, {0.25, 0.75},
+                                                 {0.375, 0.375}, {0.875, 0.875}, {0.625, 0.125}, {0.125, 0.625}};
+    for (const auto &point: expected) {
+        ASSERT_EQ(sobol(), point);
+    }
+
+    // Skip-ahead equals generating, and the bulk filling
+    cherry::Sobol<double> full(64, -1, 1), skipped(64, -1, 1);
+    std::vector<double> buffer(64 * 1000);
+    full.fill(buffer.data(), 1000);
+    skipped.skip_to(777);
+    ASSERT_EQ(skipped.index(), 777);
+    auto point = skipped();
+    for (int j = 0; j < 64; ++ j) {
+        ASSERT_EQ(point[j], buffer[777 * 64 + j]);
+    }
+
+    // Every 1-dimensional projection of the first 2^k points is stratified
+    for (int j = 0; j < 64; ++ j) {
+        std::vector<int> strata(16, 0);
+        for (int i = 0; i < 16; ++ i) {
+            auto value = buffer[i * 64 + j];
+            ASSERT_GE(value, -1);
+            ASSERT_LT(value, 1);
+            ++ strata[static_cast<int>((value + 1) / 2 * 16)];
+        }
+        ASSERT_TRUE(cherry::all_of(strata, [](const int &count) -> bool { return count == 1; }));
+    }
+
+    // Better than pseudo-random numbers on a simple integral (the mean of x * y over the unit square is 0.25)
+    cherry::Sobol<double> integrator(2);
+    double total = 0;
+    for (int i = 0; i < 4096; ++ i) {
+        auto sample = integrator();
+        total += sample[0] * sample[1];
+    }
+    ASSERT_NEAR(total / 4096, 0.25, 1e-3);
+}
+
+/// Check `Halton`
+TEST(Cherry, Halton) {
+    // Not scrambled: the radical inverses of bases 2 and 3
+    cherry::Halton<double> halton(2, 0, 1, false);
+    halton();
+    ASSERT_EQ(halton(), std::vector<double>({0.5, 1.0 / 3}));
+    ASSERT_EQ(halton(), std::vector<double>({0.25, 2.0 / 3}));
+
+    // Scrambled, scaled and skipped
+    cherry::Halton<float> scrambled(8, 10, 20, true, 42), skipped(8, 10, 20, true, 42);
+    std::vector<float> buffer(8 * 100);
+    scrambled.fill(buffer.data(), 100);
+    for (const auto &value: buffer) {
+        ASSERT_GE(value, 10);
+        ASSERT_LT(value, 20);
+    }
+    skipped.skip_to(99);
+    ASSERT_EQ(skipped()[7], buffer[99 * 8 + 7]);
+}
+
+/// Check `Zipf`, `Pareto` and `LogNormal`
+TEST(Cherry, Zipf) {
+    // Frequencies of a small Zipf distribution
+    cherry::Zipf<int> zipf(10, 1.0, false, 1);
+    std::vector<int> counts(11, 0);
+    std::vector<int> ranks(100000);
+    zipf.fill(ranks.data(), ranks.size());
+    for (const auto &rank: ranks) {
+        ASSERT_GE(rank, 1);
+        ASSERT_LE(rank, 10);
+        ++ counts[rank];
+    }
+    double harmonic = 0;
+    for (int k = 1; k <= 10; ++ k) {
+        harmonic += 1.0 / k;
+    }
+    for (int k = 1; k <= 10; ++ k) {
+        ASSERT_NEAR(counts[k] / 100000.0, 1.0 / k / harmonic, 0.01);
+    }
+
+    // Billions of items
+    cherry::Zipf<uint64_t> huge(4000000000ull, 0.99, false, 2);
+    for (int i = 0; i < 1000; ++ i) {
+        auto rank = huge();
+        ASSERT_GE(rank, 1);
+        ASSERT_LE(rank, 4000000000ull);
+    }
+
+    // Pareto and log-normal
+    cherry::Pareto<double> pareto(2.0, 3.0, false, 3);
+    std::vector<double> values(100000);
+    pareto.fill(values.data(), values.size());
+    ASSERT_GE(*std::min_element(values.begin(), values.end()), 2.0);
+    ASSERT_NEAR(cherry::sum(values) / values.size(), 3.0, 0.1);
+    cherry::LogNormal<double> log_normal(0.0, 0.5, false, 4);
+    log_normal.fill(values.data(), values.size());
+    ASSERT_NEAR(cherry::sum(values) / values.size(), std::exp(0.125), 0.02);
+}
+
+#ifdef CHERRY_COROUTINES
+/// A coroutine generating [`begin`, `end`)
+cherry::Generator<int> generate_range(int begin, int end) {
+    for (int i = begin; i < end; ++ i) {
+        co_yield i;
+    }
+}
+
+/// Check `Generator` (C++20 only)
+TEST(Cherry, Generator) {
+    ASSERT_EQ(cherry::pretty_range(generate_range(0, 5)), "[0, 1, 2, 3, 4]");
+    ASSERT_EQ(cherry::pretty_range(generate_range(0, 0)), "[]");
+    ASSERT_EQ(cherry::sum(generate_range(1, 101)), 5050);
+    ASSERT_TRUE(cherry::find(generate_range(0, 10), 7));
+    ASSERT_FALSE(cherry::find(generate_range(0, 10), 10));
+    int count = 0;
+    cherry::for_each(generate_range(0, 3), [&count](const int &value) {
+        ASSERT_EQ(value, count ++);
+    });
+    ASSERT_EQ(count, 3);
+
+    // Frames are recycled
+    for (int i = 0; i < 1000; ++ i) {
+        ASSERT_EQ(cherry::sum(generate_range(0, i % 10)), (i % 10) * (i % 10 - 1) / 2);
+    }
+
+    // Exceptions are propagated
+    auto throwing = []() -> cherry::Generator<int> {
+        co_yield 1;
+        throw std::runtime_error("generator");
+    };
+    ASSERT_THROW(static_cast<void>(cherry::sum(throwing())), std::runtime_error);
+}
+#endif
+
+/// A non-template function taking any range of `int`
+static int sum_any(const cherry::AnyRange<int, 4> &range) {
+    return cherry::sum(range);
+}
+
+/// Check `AnyRange`
+TEST(Cherry, AnyRange) {
+    // Contiguous, views and joined views
+    std::vector<int> vec = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    ASSERT_EQ(sum_any(vec), 45);
+    ASSERT_EQ(sum_any(cherry::shift(vec, 5)), 35);
+    std::vector<int> vec2 = {10, 11};
+    ASSERT_EQ(sum_any(cherry::join(cherry::shift(vec, 8), cherry::reverse(vec2))), 38);
+    cherry::AnyRange<int, 4> reversed = cherry::reverse(vec);
+    ASSERT_EQ(cherry::pretty_range(reversed), "[9, 8, 7, 6, 5, 4, 3, 2, 1, 0]");
+    ASSERT_TRUE(cherry::find(reversed, 3));
+    ASSERT_EQ(cherry::pretty_range(cherry::AnyRange<int>(std::vector<int>())), "[]");
+
+    // Owned right values
+    cherry::AnyRange<int> owned(std::vector<int>{1, 2, 3});
+    ASSERT_EQ(cherry::sum(owned), 6);
+
+    // Chunks
+    std::vector<size_t> chunk_sizes;
+    reversed.for_each_chunk([&chunk_sizes](const int *, size_t count) {
+        chunk_sizes.push_back(count);
+    });
+    ASSERT_EQ(cherry::pretty_range(chunk_sizes), "[4, 4, 2]");
+    chunk_sizes.clear();
+    cherry::AnyRange<int, 4>(vec).for_each_chunk([&](const int *items, size_t count) {
+        ASSERT_EQ(items, vec.data());
+        chunk_sizes.push_back(count);
+    });
+    ASSERT_EQ(cherry::pretty_range(chunk_sizes), "[10]");
+
+    // Contiguous ranges need contiguous iterators besides `data()` and `size()`
+    ASSERT_TRUE((cherry::is_contiguous_range<std::vector<int>, int>::value));
+    ASSERT_TRUE((cherry::is_contiguous_range<std::string, char>::value));
+    ASSERT_TRUE((cherry::is_contiguous_range<cherry::ArrayView<int>, int>::value));
+    ASSERT_FALSE((cherry::is_contiguous_range<std::vector<int>, long>::value));
+    ASSERT_FALSE((cherry::is_contiguous_range<cherry::StridedView<int, 2>, int>::value));
+}
+
+/// Check `StridedView`
+TEST(Cherry, StridedView) {
+    // A 2x3x4 tensor in row-major
+    std::vector<int> vec(24);
+    for (int i = 0; i < 24; ++ i) {
+        vec[i] = i;
+    }
+    auto tensor = cherry::strided(vec.data(), std::array<size_t, 3>{2, 3, 4});
+    ASSERT_EQ(tensor(1, 2, 3), 23);
+    ASSERT_EQ(tensor.size(), 24);
+    ASSERT_TRUE(tensor.is_contiguous());
+    ASSERT_EQ(cherry::sum(tensor), 276);
+
+    // Slice, subspan and transpose
+    auto matrix = tensor.slice(0, 1);
+    ASSERT_EQ(matrix(0, 0), 12);
+    ASSERT_EQ(cherry::pretty_range(matrix.slice(1, 1)), "[13, 17, 21]");
+    auto block = matrix.subspan({1, 1}, {2, 2});
+    ASSERT_EQ(cherry::pretty_range(block), "[17, 18, 21, 22]");
+    ASSERT_FALSE(block.is_contiguous());
+    ASSERT_EQ(cherry::pretty_range(block.transpose()), "[17, 21, 18, 22]");
+    auto permuted = tensor.transpose({2, 0, 1});
+    ASSERT_EQ(permuted.extent(0), 4);
+    ASSERT_EQ(permuted(3, 1, 2), tensor(1, 2, 3));
+
+    // Generic algorithms follow the logical order of a transposed view, not the memory order
+    std::vector<int> items = {1, 2, 3, 1, 2, 3};
+    auto transposed = cherry::strided(items.data(), std::array<size_t, 2>{2, 3}).transpose();
+    ASSERT_EQ(cherry::pretty_range(transposed), "[1, 1, 2, 2, 3, 3]");
+    ASSERT_EQ(cherry::pretty_range(cherry::AnyRange<int>(transposed)), "[1, 1, 2, 2, 3, 3]");
+    ASSERT_EQ(cherry::pretty_range(cherry::unique(transposed)), "[1, 2, 3]");
+    items = {5, 3, 1, 4, 2, 0};
+    cherry::sort(transposed);
+    ASSERT_EQ(cherry::pretty_range(transposed), "[0, 1, 2, 3, 4, 5]");
+    ASSERT_EQ(cherry::pretty_range(items), "[0, 2, 4, 1, 3, 5]");
+
+    // Column-major
+    auto column_major = cherry::strided(vec.data(), std::array<size_t, 2>{4, 6}, cherry::Layout::left);
+    ASSERT_EQ(column_major(1, 0), 1);
+    ASSERT_EQ(column_major(0, 1), 4);
+
+    // Tiled traversal visits everything once
+    std::vector<int> visited(24, 0);
+    cherry::for_each_tile(tensor, [&](int &value, const std::array<size_t, 3> &index) {
+        ASSERT_EQ(&value, &tensor(index[0], index[1], index[2]));
+        ++ visited[value];
+    }, 8);
+    ASSERT_TRUE(cherry::all_of(visited, [](const int &count) -> bool { return count == 1; }));
+
+    // Cache-oblivious transpose
+    int rows = 37, columns = 53;
+    std::vector<double> source(rows * columns), destination(rows * columns);
+    for (int i = 0; i < rows * columns; ++ i) {
+        source[i] = i;
+    }
+    auto source_view = cherry::strided(source.data(), std::array<size_t, 2>{37, 53});
+    auto destination_view = cherry::strided(destination.data(), std::array<size_t, 2>{53, 37});
+    cherry::transpose_copy(source_view, destination_view);
+    for (int i = 0; i < rows; ++ i) {
+        for (int j = 0; j < columns; ++ j) {
+            ASSERT_EQ(destination_view(j, i), source_view(i, j));
+        }
+    }
+}
+
+/// Check `iota` and `product`
+TEST(Cherry, iota) {
+    ASSERT_EQ(cherry::pretty_range(cherry::iota(5)), "[0, 1, 2, 3, 4]");
+    ASSERT_EQ(cherry::pretty_range(cherry::iota(1, 10, 3)), "[1, 4, 7]");
+    ASSERT_EQ(cherry::pretty_range(cherry::iota(10, 0, -4)), "[10, 6, 2]");
+    ASSERT_EQ(cherry::iota(3, 3).size(), 0);
+    ASSERT_EQ(cherry::iota(2u, 11u, 3).size(), 3);
+    ASSERT_EQ(cherry::pretty_range(cherry::reverse(cherry::iota(1, 10, 3))), "[7, 4, 1]");
+    ASSERT_EQ(cherry::pretty_range(cherry::shift(cherry::iota(10), 2, 3)), "[2, 3, 4]");
+    ASSERT_EQ(cherry::sum(cherry::iota(101)), 5050);
+    auto first = cherry::iota(0, 100, 2).begin();
+    ASSERT_EQ(*(3 + first), 6);
+    ASSERT_TRUE(first < 3 + first and 3 + first > first and first <= first and first >= first);
+    ASSERT_EQ(*std::lower_bound(first, first + 50, 31), 32);
+    auto range = cherry::iota(0, 100, 2);
+    ASSERT_EQ(range.end() - range.begin(), 50);
+    ASSERT_EQ(range.begin()[10], 20);
+    ASSERT_EQ(*(range.begin() + 49), 98);
+    cherry::for_each(cherry::iota(3), [](auto &value) {
+        ASSERT_LT(value, 3);
+    });
+
+    // Indexing by a counting range is a slice
+    std::vector<int> vec = {0, 10, 20, 30, 40, 50};
+    auto slice = cherry::indexing(vec, cherry::iota(1, 4));
+    ASSERT_TRUE(slice.is_contiguous());
+    ASSERT_EQ(slice.base(), vec.data() + 1);
+    for (auto &value: slice) {
+        value += 1;
+    }
+    ASSERT_EQ(cherry::pretty_range(vec), "[0, 11, 21, 31, 40, 50]");
+    const std::vector<int> &const_vec = vec;
+    ASSERT_EQ(cherry::pretty_range(cherry::indexing(const_vec, cherry::iota(0, 6, 2))), "[0, 21, 40]");
+    std::vector<int> indexes = {5, 0};
+    ASSERT_EQ(cherry::pretty_range(cherry::indexing(vec, indexes)), "[50, 0]");
+
+    // Products
+    std::vector<char> chars = {'a', 'b'};
+    std::string text;
+    for (const auto &[i, c]: cherry::product(cherry::iota(2), chars)) {
+        text += std::to_string(i) + c;
+    }
+    ASSERT_EQ(text, "0a0b1a1b");
+    ASSERT_EQ(cherry::pretty_range(cherry::map(cherry::product(cherry::iota(2), cherry::iota(0)), [](const auto &pair) {
+        return std::get<0>(pair);
+    })), "[]");
+    long long total = 0;
+    cherry::for_each(cherry::product(cherry::iota(100), cherry::iota(0, 200, 2), cherry::iota(3)), [&](int i, int j, int k) {
+        total += i * j * k;
+    });
+    ASSERT_EQ(total, 4950ll * 9900 * 3);
+}
+
+/// Check `unique`, `sort_unique` and `distinct`
+TEST(Cherry, unique) {
+    std::vector<int> sorted = {1, 1, 2, 3, 3, 3, 7};
+    ASSERT_EQ(cherry::pretty_range(cherry::unique(sorted)), "[1, 2, 3, 7]");
+    ASSERT_EQ(cherry::count_unique(std::vector<int>()), 0);
+
+    // Long runs take the SIMD path
+    std::vector<uint16_t> runs;
+    for (int i = 0; i < 50; ++ i) {
+        runs.insert(runs.end(), i % 7 + 1, static_cast<uint16_t>(i * 1000));
+    }
+    ASSERT_EQ(cherry::count_unique(runs), 50);
+    std::list<int> list = {4, 4, 5};
+    ASSERT_EQ(cherry::pretty_range(cherry::unique(list)), "[4, 5]");
+
+    std::vector<int> vec = {5, 3, 5, 1, 3};
+    ASSERT_EQ(cherry::sort_unique(vec), 3);
+    ASSERT_EQ(cherry::pretty_range(vec), "[1, 3, 5]");
+
+    std::vector<int> keys;
+    for (int i = 0; i < 100000; ++ i) {
+        keys.push_back((i * 7919) % 1000);
+    }
+    ASSERT_EQ(cherry::pretty_range(cherry::distinct(std::vector<int>{3, 1, 3, 2, 1}, true)), "[3, 1, 2]");
+    auto order = cherry::distinct(keys, true, 4);
+    ASSERT_EQ(order.size(), 1000);
+    for (int i = 0; i < 1000; ++ i) {
+        ASSERT_EQ(order[i], keys[i]);
+    }
+    ASSERT_EQ(cherry::count_distinct(keys, 3), 1000);
+    ASSERT_EQ(cherry::count_distinct(std::vector<std::string>{"a", "b", "a"}), 2);
+
+    // A partition of many threads grows its table
+    std::vector<int> skewed;
+    for (int i = 0; skewed.size() < 80000; ++ i) {
+        if (cherry::mix_hash(std::hash<int>()(i)) % 4 == 0) {
+            skewed.push_back(i), skewed.push_back(i);
+        }
+    }
+    ASSERT_EQ(cherry::distinct(skewed, false, 4).size(), 40000);
+}
+
+/// Check `constexpr` ranges, algorithms, tables and `FixedBitset`
+TEST(Cherry, constexpr) {
+    static constexpr std::array<int, 5> array = {1, 2, 3, 4, 5};
+    static_assert(cherry::sum(array) == 15);
+    static_assert(cherry::sum(cherry::shift(array, 1, 2)) == 5);
+    static_assert(*cherry::reverse(array).begin() == 5);
+    static_assert(cherry::find(cherry::join(array, array), 4));
+    static_assert(cherry::all_of(array, [](int x) { return x > 0; }));
+    static_assert(cherry::none_of(array, [](int x) { return x > 5; }));
+    static_assert(cherry::any_of(array, [](int x) { return x == 3; }));
+    static_assert(cherry::sum(cherry::iota(10)) == 45);
+    static constexpr std::array<int, 3> indexes = {0, 2, 4};
+    static_assert(cherry::sum(cherry::indexing(array, indexes)) == 9);
+    static_assert(cherry::log2(64) == 6 and cherry::lowbit(12) == 4);
+
+    // A popcount table computed at compile time
+    static constexpr auto table = cherry::make_table<256>([](size_t i) {
+        return static_cast<uint8_t>(__builtin_popcount(i));
+    });
+    static_assert(table[0] == 0 and table[255] == 8 and table[0x55] == 4);
+
+    static constexpr cherry::FixedBitset<100> primes = {2, 3, 5, 7, 11, 97};
+    static_assert(primes.count() == 6 and primes[97] and not primes[4]);
+    static_assert((primes & cherry::FixedBitset<100>({2, 4})) == cherry::FixedBitset<100>({2}));
+    static_assert(cherry::FixedBitset<100>::words_count() == 2);
+    auto bitset = primes.to_bitset();
+    ASSERT_EQ(bitset.size(), 100);
+    ASSERT_TRUE(bitset.contains({2, 3, 5, 7, 11, 97}));
+    ASSERT_FALSE(bitset.get_bit(4));
+
+#if __cplusplus >= 202002L
+    static_assert(cherry::map(array, [](int x) { return x * 2; }).size() == 5);
+#endif
+}
+
+/// Check sorting networks and `sort`
+TEST(Cherry, sort) {
+    static_assert(cherry::SortingNetwork<8>::size == 19);
+    static_assert(cherry::SortingNetwork<10>::size == 29);
+    static_assert(cherry::SortingNetwork<16>::size == 60);
+
+    // All the networks sort all the 0-1 inputs (so they sort any input)
+    for (int n = 0; n <= 16; ++ n) {
+        for (uint32_t mask = 0; mask < (1u << n); ++ mask) {
+            int items[16];
+            for (int i = 0; i < n; ++ i) {
+                items[i] = static_cast<int>((mask >> i) & 1u);
+            }
+            cherry::sort(items, items + n);
+            ASSERT_TRUE(std::is_sorted(items, items + n));
+        }
+    }
+
+    std::mt19937 engine(0);
+    for (int n = 0; n <= 40; ++ n) {
+        std::vector<double> doubles(n);
+        std::vector<std::string> strings(n);
+        std::vector<uint16_t> shorts(n);
+        for (int i = 0; i < n; ++ i) {
+            doubles[i] = static_cast<double>(engine() % 100) / 7;
+            strings[i] = std::to_string(engine() % 100);
+            shorts[i] = static_cast<uint16_t>(engine());
+        }
+        auto expected = doubles;
+        std::sort(expected.begin(), expected.end());
+        cherry::sort(doubles);
+        ASSERT_EQ(doubles, expected);
+        cherry::sort(strings);
+        ASSERT_TRUE(std::is_sorted(strings.begin(), strings.end()));
+        cherry::sort(shorts, std::greater<>());
+        ASSERT_TRUE(std::is_sorted(shorts.begin(), shorts.end(), std::greater<>()));
+    }
+
+    std::array<float, 5> floats = {3, 1, 4, 1, 5};
+    cherry::sort(floats);
+    ASSERT_EQ(cherry::pretty_range(floats), "[1, 1, 3, 4, 5]");
+    // Equal items keep their places (signed zeros compare equal)
+    std::array<double, 2> zeros = {-0.0, 0.0};
+    cherry::sort(zeros);
+    ASSERT_TRUE(std::signbit(zeros[0]) and not std::signbit(zeros[1]));
+    double mixed[] = {0.0, -0.0, 1.0};
+    cherry::sort<3>(mixed);
+    ASSERT_TRUE(not std::signbit(mixed[0]) and std::signbit(mixed[1]));
+    ASSERT_EQ(mixed[2], 1.0);
+    std::array<int, 24> large{};
+    for (int i = 0; i < 24; ++ i) {
+        large[i] = (i * 7) % 24;
+    }
+    cherry::sort(large);
+    ASSERT_TRUE(std::is_sorted(large.begin(), large.end()));
+}
+
+/// Check `radix_sort` and `external_sort`
+TEST(Cherry, external_sort) {
+    struct Record {
+        int32_t key;
+        char payload[12];
+    };
+    std::mt19937 engine(0);
+    std::vector<Record> records(100000);
+    for (auto &record: records) {
+        record.key = static_cast<int32_t>(engine());
+        std::snprintf(record.payload, sizeof(record.payload), "%d", record.key);
+    }
+    std::vector<Record> scratch(records.size()), sorted = records;
+    auto key = [](const Record &record) {
+        return record.key;
+    };
+    cherry::radix_sort(sorted.data(), scratch.data(), sorted.size(), key);
+    ASSERT_TRUE(std::is_sorted(sorted.begin(), sorted.end(), [](const Record &a, const Record &b) {
+        return a.key < b.key;
+    }));
+
+    // A tiny budget forces many runs and an extra merge pass
+    std::string input = "cherry_external_sort_input.bin", output = "cherry_external_sort_output.bin";
+    std::ofstream(input, std::ios::binary).write(reinterpret_cast<const char*>(records.data()),
+                                                 static_cast<std::streamsize>(records.size() * sizeof(Record)));
+    cherry::ExternalSortOptions options;
+    options.memory_budget = cherry::Unit::KiB(64);
+    options.io_chunk = cherry::Unit::KiB(4);
+    options.threads = 3;
+    size_t run_reports = 0, processed = 0;
+    options.progress = [&](const cherry::ExternalSortProgress &progress) {
+        run_reports += std::string(progress.phase) == "run";
+        processed = progress.processed_bytes;
+    };
+    ASSERT_TRUE(cherry::external_sort<Record>(input, output, options, key));
+    ASSERT_GT(run_reports, 15);
+    ASSERT_EQ(processed, records.size() * sizeof(Record));
+    std::vector<Record> result(records.size());
+    std::ifstream(output, std::ios::binary).read(reinterpret_cast<char*>(result.data()),
+                                                 static_cast<std::streamsize>(result.size() * sizeof(Record)));
+    for (size_t i = 0; i < result.size(); ++ i) {
+        ASSERT_EQ(result[i].key, sorted[i].key);
+        ASSERT_EQ(std::string(result[i].payload), std::to_string(result[i].key));
+    }
+
+    // Non-integer keys are sorted by comparison
+    std::vector<double> doubles = {2.5, -1, 3, 0.5};
+    std::ofstream(input, std::ios::binary).write(reinterpret_cast<const char*>(doubles.data()), sizeof(double) * 4);
+    ASSERT_TRUE(cherry::external_sort<double>(input, output));
+    std::ifstream(output, std::ios::binary).read(reinterpret_cast<char*>(doubles.data()), sizeof(double) * 4);
+    ASSERT_EQ(cherry::pretty_range(doubles), "[-1, 0.5, 2.5, 3]");
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+    ASSERT_FALSE(cherry::external_sort<double>(input, output));
+}
+
+/// Test `Sink`
+TEST(Cherry, Sink) {
+    // Formatting is compatible with `std::ostream`
+    char buffer[cherry::max_formatted_length];
+    auto format = [&buffer](auto value) {
+        return std::string(buffer, cherry::format_value(buffer, value));
+    };
+    ASSERT_EQ(format(-42), "-42");
+    ASSERT_EQ(format(3.14159265), "3.14159");
+    ASSERT_EQ(format(1e20), "1e+20");
+    ASSERT_EQ(format('x'), "x");
+    ASSERT_EQ(format(true), "1");
+    ASSERT_EQ(cherry::pretty_range(std::vector<double>{0.1, 2, 1.0 / 3}), "[0.1, 2, 0.333333]");
+
+    std::string path = "cherry_sink.txt";
+    int fd = open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    ASSERT_GE(fd, 0);
+    auto content = [&path]() {
+        std::ifstream file(path);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    };
+    {
+        // Buffered until flushed
+        cherry::Sink sink(fd, cherry::FlushPolicy::full, 128);
+        sink.print("a=", 1, ", b=", 2.5, '\n');
+        ASSERT_EQ(sink.buffered(), 11);
+        ASSERT_EQ(content(), "");
+        sink.flush();
+        ASSERT_EQ(content(), "a=1, b=2.5\n");
+
+        // A disabled sink prints nothing
+        sink.enable(false);
+        sink.print("hidden");
+        ASSERT_EQ(sink.buffered(), 0);
+        sink.enable();
+
+        // Large strings are written with the buffered bytes together
+        sink.print_separated(" ", "x", 7);
+        std::string large(1000, 'y');
+        sink.write(large.data(), large.size());
+        ASSERT_EQ(sink.buffered(), 0);
+        ASSERT_EQ(content(), "a=1, b=2.5\nx 7" + large);
+
+        // Many small values overflow the buffer correctly
+        for (int i = 0; i < 100; ++ i) {
+            sink.print(i, ' ');
+        }
+    }
+    std::string expected = "a=1, b=2.5\nx 7" + std::string(1000, 'y');
+    for (int i = 0; i < 100; ++ i) {
+        expected += std::to_string(i) + " ";
+    }
+    ASSERT_EQ(content(), expected);
+    {
+        // Line policy flushes after line breaks, always policy flushes every print
+        cherry::Sink line(fd, cherry::FlushPolicy::line), always(fd, cherry::FlushPolicy::always);
+        line.print("no break");
+        ASSERT_EQ(line.buffered(), 8);
+        line.print(std::string(" break\n"));
+        ASSERT_EQ(line.buffered(), 0);
+        always.print(1);
+        ASSERT_EQ(always.buffered(), 0);
+        ASSERT_FALSE(line.fail() or always.fail());
+    }
+    ASSERT_EQ(content(), expected + "no break break\n1");
+    close(fd);
+    std::remove(path.c_str());
+
+    // Writing into a closed descriptor fails
+    cherry::Sink closed(fd, cherry::FlushPolicy::always);
+    closed.print("lost");
+    ASSERT_TRUE(closed.fail());
+
+    // `print_args` and `debug_print` flush the standard output sink, unless buffering is opted in
+    auto &output = cherry::Sink::standard_output();
+    cherry::print_args("print_args", 1);
+    ASSERT_EQ(output.buffered(), 0);
+    cherry::buffered_print_args = true;
+    cherry::print_args("buffered\n");
+    cherry::buffered_print_args = false;
+    debug_print("flushed");
+    ASSERT_EQ(output.buffered(), 0);
+}
+
+/// Test `Latch`, `Barrier`, `Event` and `Semaphore`
+TEST(Cherry, sync) {
+    constexpr int threads_count = 8, rounds = 200;
+
+    // Latch and event
+    cherry::Latch latch(threads_count);
+    cherry::Event start;
+    std::atomic<int> started = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threads_count; ++ i) {
+        threads.emplace_back([&]() {
+            start.wait();
+            ++ started;
+            latch.count_down();
+        });
+    }
+    ASSERT_FALSE(latch.try_wait());
+    ASSERT_EQ(started, 0);
+    start.set();
+    ASSERT_TRUE(start.is_set());
+    latch.wait();
+    ASSERT_TRUE(latch.try_wait());
+    ASSERT_EQ(started, threads_count);
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    start.reset();
+    ASSERT_FALSE(start.is_set());
+
+    // Every phase sees the writes of all the threads before the completion
+    std::vector<int> slots(threads_count);
+    int completed = 0, serial_threads = 0;
+    bool consistent = true;
+    cherry::Barrier barrier(threads_count, [&]() {
+        for (int slot: slots) {
+            consistent = consistent and slot == completed + 1;
+        }
+        ++ completed;
+    });
+    std::atomic<int> serial = 0;
+    threads.clear();
+    for (int i = 0; i < threads_count; ++ i) {
+        threads.emplace_back([&, i]() {
+            for (int round = 0; round < rounds; ++ round) {
+                slots[i] = round + 1;
+                serial += barrier.arrive_and_wait();
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    serial_threads = serial;
+    ASSERT_TRUE(consistent);
+    ASSERT_EQ(completed, rounds);
+    ASSERT_EQ(serial_threads, rounds);
+    ASSERT_EQ(barrier.phases(), rounds);
+
+    // Semaphore bounds the concurrency
+    cherry::Semaphore semaphore(2);
+    std::atomic<int> inside = 0, max_inside = 0;
+    threads.clear();
+    for (int i = 0; i < threads_count; ++ i) {
+        threads.emplace_back([&]() {
+            for (int round = 0; round < 50; ++ round) {
+                semaphore.acquire();
+                int now = ++ inside, previous = max_inside;
+                while (now > previous and not max_inside.compare_exchange_weak(previous, now));
+                -- inside;
+                semaphore.release();
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    ASSERT_LE(max_inside, 2);
+    ASSERT_EQ(semaphore.count(), 2);
+    ASSERT_TRUE(semaphore.try_acquire());
+    ASSERT_TRUE(semaphore.try_acquire());
+    ASSERT_FALSE(semaphore.try_acquire());
+    semaphore.release(2);
+    ASSERT_EQ(semaphore.count(), 2);
+}
+
+/// Test `BTreeSet` and `BTreeMap`
+TEST(Cherry, BTree) {
+    // SIMD ranks agree with the binary search
+    std::vector<int64_t> signed_keys = {-5, -1, 0, 3, 3, 8, 9};
+    std::vector<uint32_t> unsigned_keys = {1, 2, 0x80000000u, 0xfffffff0u, 0xffffffffu};
+    std::vector<float> float_keys = {-2.5f, 0, 1, 1, 1, 7.5f};
+    for (int64_t x = -6; x <= 10; ++ x) {
+        ASSERT_EQ(cherry::node_rank<false>(signed_keys.data(), signed_keys.size(), x, std::less<int64_t>()),
+                  std::lower_bound(signed_keys.begin(), signed_keys.end(), x) - signed_keys.begin());
+        ASSERT_EQ(cherry::node_rank<true>(signed_keys.data(), signed_keys.size(), x, std::less<int64_t>()),
+                  std::upper_bound(signed_keys.begin(), signed_keys.end(), x) - signed_keys.begin());
+        auto y = static_cast<float>(x) / 2;
+        ASSERT_EQ(cherry::node_rank<true>(float_keys.data(), float_keys.size(), y, std::less<float>()),
+                  std::upper_bound(float_keys.begin(), float_keys.end(), y) - float_keys.begin());
+    }
+    for (uint32_t x: {0u, 2u, 3u, 0x80000000u, 0xfffffff5u, 0xffffffffu}) {
+        ASSERT_EQ(cherry::node_rank<false>(unsigned_keys.data(), unsigned_keys.size(), x, std::less<uint32_t>()),
+                  std::lower_bound(unsigned_keys.begin(), unsigned_keys.end(), x) - unsigned_keys.begin());
+    }
+
+    // Random insertions and erasures against `std::set`
+    cherry::BTreeSet<int> set;
+    std::set<int> reference;
+    std::mt19937 generator(42);
+    for (int i = 0; i < 100000; ++ i) {
+        int value = static_cast<int>(generator() % 50000);
+        ASSERT_EQ(set.insert(value).second, reference.insert(value).second);
+    }
+    ASSERT_EQ(set.size(), reference.size());
+    ASSERT_GT(set.depth(), 2);
+    ASSERT_TRUE(std::equal(set.begin(), set.end(), reference.begin(), reference.end()));
+    for (int i = 0; i < 60000; ++ i) {
+        int value = static_cast<int>(generator() % 50000);
+        ASSERT_EQ(set.erase(value), reference.erase(value));
+    }
+    ASSERT_TRUE(std::equal(set.begin(), set.end(), reference.begin(), reference.end()));
+    ASSERT_TRUE(std::equal(set.rbegin(), set.rend(), reference.rbegin(), reference.rend()));
+    for (int x: {-1, 0, 777, 25000, 49999, 50000}) {
+        ASSERT_EQ(set.contains(x), reference.count(x) == 1);
+        auto lower = set.lower_bound(x);
+        auto upper = set.upper_bound(x);
+        ASSERT_EQ(lower == set.end(), reference.lower_bound(x) == reference.end());
+        ASSERT_EQ(upper == set.end(), reference.upper_bound(x) == reference.end());
+        if (lower != set.end()) {
+            ASSERT_EQ(*lower, *reference.lower_bound(x));
+        }
+        if (upper != set.end()) {
+            ASSERT_EQ(*upper, *reference.upper_bound(x));
+        }
+    }
+    while (not set.empty()) {
+        set.erase(set.begin());
+    }
+    ASSERT_EQ(set.depth(), 0);
+    ASSERT_EQ(set.begin(), set.end());
+
+    // Bulk load from a sorted range, with `shift` and `reverse`
+    std::vector<int> sorted(1000);
+    for (int i = 0; i < 1000; ++ i) {
+        sorted[i] = i * 2;
+    }
+    set.bulk_load(sorted);
+    ASSERT_EQ(set.size(), 1000);
+    ASSERT_TRUE(std::equal(set.begin(), set.end(), sorted.begin(), sorted.end()));
+    ASSERT_EQ(set.end() - set.begin(), 1000);
+    ASSERT_EQ(*(set.begin() + 500), 1000);
+    ASSERT_EQ(*(set.end() - 1), 1998);
+    ASSERT_EQ(cherry::pretty_range(cherry::shift(set, 995)), "[1990, 1992, 1994, 1996, 1998]");
+    ASSERT_EQ(cherry::pretty_range(cherry::shift(cherry::reverse(set), 0, 3)), "[1998, 1996, 1994]");
+    ASSERT_EQ(cherry::sum(cherry::shift(set, 10, 5)), 20 + 22 + 24 + 26 + 28);
+    set.insert(1);
+    ASSERT_EQ(*++ set.begin(), 1);
+    ASSERT_TRUE(set.contains(1) and not set.contains(3));
+    auto copy = set;
+    ASSERT_EQ(copy.size(), 1001);
+    ASSERT_TRUE(std::equal(copy.begin(), copy.end(), set.begin(), set.end()));
+
+    // Maps with non-trivial values and unsorted bulk loads
+    cherry::BTreeMap<std::string, int> map = {{"pear", 3}, {"apple", 1}, {"fig", 2}, {"apple", 9}};
+    ASSERT_EQ(map.size(), 3);
+    ASSERT_EQ(map.begin().key(), "apple");
+    ASSERT_EQ(map.begin().value(), 1);
+    map["kiwi"] = 4;
+    ++ map["fig"];
+    ASSERT_FALSE(map.insert("pear", 5).second);
+    std::string joined;
+    for (auto [key, value]: map) {
+        joined += key + "=" + std::to_string(value) + " ";
+    }
+    ASSERT_EQ(joined, "apple=1 fig=3 kiwi=4 pear=3 ");
+    ASSERT_EQ(map.find("kiwi").value(), 4);
+    ASSERT_EQ(map.find("plum"), map.end());
+    ASSERT_EQ(map.erase("fig"), 1);
+    ASSERT_EQ(map.count("fig"), 0);
+    std::map<int, std::string> big;
+    cherry::BTreeMap<int, std::string> big_tree;
+    for (int i = 0; i < 5000; ++ i) {
+        int key = static_cast<int>(generator() % 3000);
+        big[key] = big_tree[key] = std::to_string(i);
+    }
+    ASSERT_EQ(big_tree.size(), big.size());
+    auto it = big.begin();
+    for (auto [key, value]: big_tree) {
+        ASSERT_EQ(key, it->first);
+        ASSERT_EQ(value, it->second);
+        ++ it;
+    }
+}
+
+/// Test `EpochManager`
+TEST(Cherry, EpochManager) {
+    static std::atomic<int> freed;
+    freed = 0;
+    auto deleter = [](void *) {
+        ++ freed;
+    };
+    {
+        cherry::EpochManager manager;
+        {
+            // A stalled reader keeps everything retired after it
+            auto reader = manager.pin();
+            auto writer = manager.pin();
+            for (int i = 0; i < 10000; ++ i) {
+                writer.retire(nullptr, deleter);
+            }
+            ASSERT_EQ(freed, 0);
+        }
+        // Collected by later retirements once the epoch moves
+        for (int i = 0; i < 1000; ++ i) {
+            manager.pin().retire(nullptr, deleter);
+        }
+        ASSERT_GT(freed, 0);
+
+        // Pinning yields while all the slots are taken
+        std::vector<cherry::EpochManager::Guard> guards;
+        for (int i = 0; i < 128; ++ i) {
+            guards.push_back(manager.pin());
+        }
+        std::atomic<bool> pinned = false;
+        std::thread thread([&]() {
+            auto guard = manager.pin();
+            pinned = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ASSERT_FALSE(pinned);
+        guards.pop_back();
+        thread.join();
+        ASSERT_TRUE(pinned);
+    }
+    ASSERT_EQ(freed, 11000);
+}
+
+/// Test `SkipListSet` and `SkipListMap`
+TEST(Cherry, SkipList) {
+    // Sequential behavior against `std::set`
+    cherry::SkipListSet<int> set;
+    std::set<int> reference;
+    std::mt19937 generator(7);
+    for (int i = 0; i < 20000; ++ i) {
+        int value = static_cast<int>(generator() % 5000);
+        if (generator() % 3 == 0) {
+            ASSERT_EQ(set.erase(value), reference.erase(value) == 1);
+        } else {
+            ASSERT_EQ(set.insert(value), reference.insert(value).second);
+        }
+    }
+    ASSERT_EQ(set.size(), reference.size());
+    auto all = set.scan();
+    ASSERT_TRUE(std::equal(all.begin(), all.end(), reference.begin(), reference.end()));
+    for (int x: {-1, 0, 100, 4999}) {
+        ASSERT_EQ(set.contains(x), reference.count(x) == 1);
+    }
+    auto part = set.scan(100, 200);
+    ASSERT_EQ(cherry::sum(part), std::accumulate(reference.lower_bound(100), reference.lower_bound(200), 0));
+
+    // Concurrent inserters and erasers with readers scanning
+    constexpr int threads_count = 4, per_thread = 20000;
+    cherry::SkipListMap<int, int> map;
+    std::atomic<bool> sorted = true;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; ++ t) {
+        threads.emplace_back([&map, t]() {
+            for (int i = 0; i < per_thread; ++ i) {
+                int key = i * threads_count + t;
+                map.insert(key, -key);
+                // Erase every key which is a multiple of 3 again
+                if (key % 3 == 0) {
+                    map.erase(key);
+                }
+            }
+        });
+        threads.emplace_back([&map, &sorted]() {
+            for (int round = 0; round < 50; ++ round) {
+                int previous = -1;
+                for (auto [key, value]: map.scan(round * 100, round * 100 + 5000)) {
+                    sorted = sorted and key > previous and value == -key;
+                    previous = key;
+                }
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    ASSERT_TRUE(sorted);
+    ASSERT_EQ(map.size(), threads_count * per_thread - (threads_count * per_thread + 2) / 3);
+    int expected = 0;
+    for (auto [key, value]: map.scan()) {
+        while (expected % 3 == 0) {
+            ++ expected;
+        }
+        ASSERT_EQ(key, expected);
+        ++ expected;
+    }
+    ASSERT_EQ(map.get(4).value(), -4);
+    ASSERT_FALSE(map.get(3).has_value());
+    ASSERT_FALSE(map.insert(4, 0));
+}
+
+/// Test `SparseSet` and `GenerationSparseSet`
+TEST(Cherry, SparseSet) {
+    auto check = [](auto &set) {
+        std::set<uint32_t> reference;
+        std::mt19937 generator(3);
+        for (int round = 0; round < 5; ++ round) {
+            for (int i = 0; i < 3000; ++ i) {
+                auto item = static_cast<uint32_t>(generator() % 1000);
+                if (generator() % 4 == 0) {
+                    ASSERT_EQ(set.erase(item), reference.erase(item) == 1);
+                } else {
+                    ASSERT_EQ(set.insert(item), reference.insert(item).second);
+                }
+            }
+            ASSERT_EQ(set.size(), reference.size());
+            std::vector<uint32_t> items(set.begin(), set.end());
+            std::sort(items.begin(), items.end());
+            ASSERT_TRUE(std::equal(items.begin(), items.end(), reference.begin(), reference.end()));
+            for (uint32_t item = 0; item < 1000; ++ item) {
+                ASSERT_EQ(set.contains(item), reference.count(item) == 1);
+            }
+            set.clear();
+            reference.clear();
+            ASSERT_TRUE(set.empty());
+            ASSERT_FALSE(set.contains(0) or set.contains(999));
+        }
+
+        // Insertion order, and conversions to and from `Bitset`
+        for (uint32_t item: {42u, 7u, 999u, 0u}) {
+            set.insert(item);
+        }
+        ASSERT_EQ(cherry::pretty_range(set), "[42, 7, 999, 0]");
+        ASSERT_EQ(cherry::pretty_range(cherry::reverse(set)), "[0, 999, 7, 42]");
+        ASSERT_EQ(cherry::pretty_range(cherry::shift(set, 1, 2)), "[7, 999]");
+        set.erase(7);
+        ASSERT_EQ(cherry::pretty_range(set), "[42, 0, 999]");
+        auto bitset = set.to_bitset();
+        ASSERT_EQ(bitset.size(), 1000);
+        ASSERT_TRUE(bitset.get_bit(42) and bitset.get_bit(999) and not bitset.get_bit(7));
+        typename std::decay<decltype(set)>::type from_bitset(bitset);
+        ASSERT_EQ(cherry::pretty_range(from_bitset), "[0, 42, 999]");
+    };
+    cherry::SparseSet<uint32_t> sparse_set(1000);
+    check(sparse_set);
+    cherry::SparseSet<uint16_t> small_set(1000);
+    small_set.insert(3);
+    ASSERT_TRUE(small_set.contains(3) and not small_set.contains(4));
+    cherry::GenerationSparseSet generation_set(1000);
+    check(generation_set);
+}